@@ -25,6 +25,7 @@ SOURCES += \
     src/ornrepomodel.cpp \
     src/ornproxymodel.cpp \
     src/ornapplication.cpp \
+    src/ornappdetails.cpp \
     src/ornapplistitem.cpp \
     src/orncommentlistitem.cpp \
     src/ornsearchappsmodel.cpp \
@@ -32,10 +33,21 @@ SOURCES += \
     src/orncategorylistitem.cpp \
     src/orncategoryappsmodel.cpp \
     src/orninstalledappsmodel.cpp \
+    src/ornupdatesmodel.cpp \
+    src/ornavailablepackagesmodel.cpp \
     src/ornbookmarksmodel.cpp \
-#    src/ornbackup.cpp \
+    src/ornbackup.cpp \
     src/ornpm.cpp \
-    src/ornpackageversion.cpp
+    src/ornpackageversion.cpp \
+    src/ornpackageindex.cpp \
+    src/ornsysteminfo.cpp \
+    src/orntransactionjournal.cpp \
+    src/ornnetworkcache.cpp \
+    src/ornapidispatcher.cpp \
+    src/ornapiworker.cpp \
+    src/ornapistats.cpp \
+    src/ornjsonarrayreader.cpp \
+    src/ornjsonreader.cpp
 
 HEADERS += \
     src/orn_plugin.h \
@@ -50,6 +62,7 @@ HEADERS += \
     src/ornrepomodel.h \
     src/ornproxymodel.h \
     src/ornapplication.h \
+    src/ornappdetails.h \
     src/ornapplistitem.h \
     src/orncommentlistitem.h \
     src/ornsearchappsmodel.h \
@@ -57,12 +70,27 @@ HEADERS += \
     src/orncategorylistitem.h \
     src/orncategoryappsmodel.h \
     src/orninstalledappsmodel.h \
+    src/ornupdatesmodel.h \
+    src/ornavailablepackagesmodel.h \
     src/ornbookmarksmodel.h \
-#    src/ornbackup.h \
+    src/ornbackup.h \
     src/ornpm.h \
     src/ornpm_p.h \
     src/ornpackageversion.h \
+    src/ornpackageindex.h \
+    src/ornpackageid.h \
+    src/ornsysteminfo.h \
+    src/ornssu.h \
+    src/orntransactionjournal.h \
+    src/ornnetworkcache.h \
+    src/ornapidispatcher.h \
+    src/ornapiworker.h \
+    src/ornapistats.h \
+    src/ornjsonarrayreader.h \
+    src/ornjsonreader.h \
     src/orninstalledpackage.h \
+    src/ornupdatablepackage.h \
+    src/orninstallpreview.h \
     src/ornrepo.h
 
 OTHER_FILES += \
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+'''
+Fake PackageKit and SSU D-Bus services for testing and benchmarking OrnPm
+on a plain Linux box.
+
+The services implement only the methods and signals used by OrnPm.
+Latency and failures are scripted with a JSON scenario file:
+
+{
+    "deviceModel": "Fake device",
+    "updates": ["harbour-app;1.1-1;armv7hl;openrepos-user"],
+    "latency": { "InstallPackages": 500, "addRepo": 100 },
+    "fail": { "InstallPackages": ["harbour-broken"], "RepoSetData": true }
+}
+
+Latency is in milliseconds. A failure is either true to fail every call
+of the method or a list of substrings of the failing items.
+
+Run the services on a private session bus and point OrnPm at it:
+
+    dbus-run-session -- sh -c '
+        scripts/fake_pm_services.py --ssu-config /tmp/ssu.ini &
+        ORN_PM_BUS=session ORN_SSU_CONFIG=/tmp/ssu.ini harbour-storeman'
+
+Requires dbus-python and PyGObject.
+'''
+
+import argparse
+import configparser
+import json
+import os
+import sys
+
+import dbus
+import dbus.service
+from dbus.mainloop.glib import DBusGMainLoop
+from gi.repository import GLib
+
+PK_SERVICE = 'org.freedesktop.PackageKit'
+PK_PATH = '/org/freedesktop/PackageKit'
+PK_INTERFACE = 'org.freedesktop.PackageKit'
+PK_TR_INTERFACE = 'org.freedesktop.PackageKit.Transaction'
+
+SSU_SERVICE = 'org.nemo.ssu'
+SSU_PATH = '/org/nemo/ssu'
+SSU_INTERFACE = 'org.nemo.ssu'
+
+# PackageKit enums
+EXIT_SUCCESS = 1
+EXIT_FAILED = 2
+# The info of the updates reported by the Sailfish PackageKit backend
+INFO_ENHANCEMENT = 4
+ERROR_PACKAGE_NOT_FOUND = 8
+
+# A finished transaction stays on the bus for a while like in PackageKit,
+# so its properties can still be read, in milliseconds
+TRANSACTION_LINGER = 5000
+
+# OrnPm::RepoAction
+REMOVE_REPO, ADD_REPO, DISABLE_REPO, ENABLE_REPO = range(4)
+
+
+class Scenario:
+    def __init__(self, path):
+        self.data = {}
+        if path:
+            with open(path) as f:
+                self.data = json.load(f)
+
+    def latency(self, method):
+        return int(self.data.get('latency', {}).get(method, 0))
+
+    def fails(self, method, items):
+        fail = self.data.get('fail', {}).get(method, False)
+        if isinstance(fail, list):
+            return any(p in i for p in fail for i in items)
+        return bool(fail)
+
+    @property
+    def updates(self):
+        return self.data.get('updates', [])
+
+    @property
+    def device_model(self):
+        return self.data.get('deviceModel', 'Fake device')
+
+
+def delayed(scenario, method, callback):
+    '''Run the callback after the scripted latency of the method'''
+    def run():
+        callback()
+        return False
+    GLib.timeout_add(scenario.latency(method), run)
+
+
+class Transaction(dbus.service.Object):
+    def __init__(self, bus, path, scenario):
+        super().__init__(bus, path)
+        self.scenario = scenario
+        self.last_package = ''
+
+    def _finish(self, method, items, on_success=None):
+        def finish():
+            if self.scenario.fails(method, items):
+                self.ErrorCode(dbus.UInt32(ERROR_PACKAGE_NOT_FOUND),
+                               '{} failed for {}'.format(method, ', '.join(items)))
+                exit = EXIT_FAILED
+            else:
+                if on_success:
+                    on_success()
+                exit = EXIT_SUCCESS
+            self.Finished(dbus.UInt32(exit), dbus.UInt32(self.scenario.latency(method)))
+            GLib.timeout_add(TRANSACTION_LINGER, self._destroy)
+        delayed(self.scenario, method, finish)
+
+    def _destroy(self):
+        self.Destroy()
+        self.remove_from_connection()
+        return False
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='t')
+    def GetUpdates(self, flags):
+        def emit():
+            for package_id in self.scenario.updates:
+                self.last_package = package_id
+                self.Package(dbus.UInt32(INFO_ENHANCEMENT), package_id, '')
+        self._finish('GetUpdates', [], emit)
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='tas')
+    def InstallPackages(self, flags, ids):
+        self.last_package = ids[-1] if ids else ''
+        self._finish('InstallPackages', ids)
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='tasbb')
+    def RemovePackages(self, flags, ids, allow_deps, autoremove):
+        self.last_package = ids[-1] if ids else ''
+        self._finish('RemovePackages', ids)
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='tas')
+    def UpdatePackages(self, flags, ids):
+        self.last_package = ids[-1] if ids else ''
+        self._finish('UpdatePackages', ids)
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='sss')
+    def RepoSetData(self, repo_id, parameter, value):
+        self._finish('RepoSetData', [repo_id])
+
+    @dbus.service.method(PK_TR_INTERFACE, in_signature='b')
+    def RefreshCache(self, force):
+        self._finish('RefreshCache', [])
+
+    @dbus.service.signal(PK_TR_INTERFACE, signature='uss')
+    def Package(self, info, package_id, summary):
+        pass
+
+    @dbus.service.signal(PK_TR_INTERFACE, signature='us')
+    def ErrorCode(self, code, details):
+        pass
+
+    @dbus.service.signal(PK_TR_INTERFACE, signature='uu')
+    def Finished(self, exit, runtime):
+        pass
+
+    @dbus.service.signal(PK_TR_INTERFACE)
+    def Destroy(self):
+        pass
+
+    @dbus.service.method(dbus.PROPERTIES_IFACE, in_signature='ss', out_signature='v')
+    def Get(self, interface, name):
+        return self.GetAll(interface)[name]
+
+    @dbus.service.method(dbus.PROPERTIES_IFACE, in_signature='s', out_signature='a{sv}')
+    def GetAll(self, interface):
+        return {'LastPackage': self.last_package}
+
+
+class PackageKit(dbus.service.Object):
+    def __init__(self, bus, scenario):
+        super().__init__(bus, PK_PATH)
+        self.bus = bus
+        self.scenario = scenario
+        self.counter = 0
+
+    @dbus.service.method(PK_INTERFACE, out_signature='o')
+    def CreateTransaction(self):
+        self.counter += 1
+        path = '/{}_fake'.format(self.counter)
+        Transaction(self.bus, path, self.scenario)
+        return dbus.ObjectPath(path)
+
+    @dbus.service.signal(PK_INTERFACE)
+    def UpdatesChanged(self):
+        pass
+
+
+class Ssu(dbus.service.Object):
+    def __init__(self, bus, scenario, config):
+        super().__init__(bus, SSU_PATH)
+        self.scenario = scenario
+        self.config = config
+
+    def _modify(self, method, alias, change, reply, error):
+        def finish():
+            if self.scenario.fails(method, [alias]):
+                error(dbus.DBusException('{} failed for {}'.format(method, alias)))
+                return
+            if self.config:
+                self._change_config(change)
+            reply()
+        delayed(self.scenario, method, finish)
+
+    def _change_config(self, change):
+        ini = configparser.ConfigParser(interpolation=None)
+        ini.optionxform = str
+        ini.read(self.config)
+        for section in ('General', 'repository-urls'):
+            if not ini.has_section(section):
+                ini.add_section(section)
+        disabled = [r for r in ini.get('General', 'disabled-repos', fallback='').split(',') if r]
+        change(ini, disabled)
+        ini.set('General', 'disabled-repos', ','.join(disabled))
+        with open(self.config, 'w') as f:
+            ini.write(f, space_around_delimiters=False)
+
+    @dbus.service.method(SSU_INTERFACE, in_signature='i', out_signature='s')
+    def displayName(self, kind):
+        return self.scenario.device_model
+
+    @dbus.service.method(SSU_INTERFACE, in_signature='ss',
+                         async_callbacks=('reply', 'error'))
+    def addRepo(self, alias, url, reply, error):
+        def change(ini, disabled):
+            ini.set('repository-urls', alias, url)
+        self._modify('addRepo', alias, change, reply, error)
+
+    @dbus.service.method(SSU_INTERFACE, in_signature='is',
+                         async_callbacks=('reply', 'error'))
+    def modifyRepo(self, action, alias, reply, error):
+        def change(ini, disabled):
+            if action == REMOVE_REPO:
+                ini.remove_option('repository-urls', alias)
+            if action in (REMOVE_REPO, ENABLE_REPO) and alias in disabled:
+                disabled.remove(alias)
+            elif action == DISABLE_REPO and alias not in disabled:
+                disabled.append(alias)
+        self._modify('modifyRepo', alias, change, reply, error)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Fake PackageKit and SSU services')
+    parser.add_argument('--scenario', help='JSON file with scripted latency and failures')
+    parser.add_argument('--ssu-config', help='ssu.ini to update on repo changes')
+    parser.add_argument('--address', help='D-Bus address, the session bus by default')
+    args = parser.parse_args()
+
+    DBusGMainLoop(set_as_default=True)
+    if args.address:
+        bus = dbus.bus.BusConnection(args.address)
+    else:
+        bus = dbus.SessionBus()
+
+    scenario = Scenario(args.scenario)
+    # Keep the names and the objects alive
+    names = [dbus.service.BusName(PK_SERVICE, bus), dbus.service.BusName(SSU_SERVICE, bus)]
+    services = [PackageKit(bus, scenario), Ssu(bus, scenario, args.ssu_config)]
+
+    print('Fake services are running on', args.address or os.environ.get(
+        'DBUS_SESSION_BUS_ADDRESS', 'the session bus'), file=sys.stderr)
+    GLib.MainLoop().run()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+'''
+Generate a synthetic solv cache to measure OrnPm queries at scale.
+
+The output dir gets the @System/solv file with the installed packages,
+an openrepos-*/solv file for every repo and an ssu.ini listing the repos.
+The benchmarks in tests/benchmarks/ornpm run it for 10, 100 and 1000 repos.
+To point OrnPm at a corpus manually:
+
+    scripts/generate_solv_corpus.py /tmp/solv --repos 1000 --packages 100
+    ORN_SOLV_ROOT=/tmp/solv ORN_SSU_CONFIG=/tmp/solv/ssu.ini ...
+
+Requires the python bindings of libsolv.
+'''
+
+import argparse
+import os
+import random
+
+import solv
+
+REPO_PREFIX = 'openrepos-'
+REPO_URL = 'https://sailfish.openrepos.net/{}/personal/main'
+ALPHABET = 'abcdefghijklmnopqrstuvwxyz'
+
+
+def random_name(rng):
+    return 'harbour-' + ''.join(rng.choice(ALPHABET) for _ in range(rng.randint(4, 12)))
+
+
+def add_package(repo, name, evr, arch, rng):
+    pool = repo.pool
+    s = repo.add_solvable()
+    s.name = name
+    s.evr = evr
+    s.arch = arch
+    s.add_deparray(solv.SOLVABLE_PROVIDES, pool.rel2id(s.nameid, s.evrid, solv.REL_EQ))
+    s.set_num(solv.SOLVABLE_DOWNLOADSIZE, rng.randint(10, 10000) * 1024)
+    s.set_num(solv.SOLVABLE_INSTALLSIZE, rng.randint(20, 40000) * 1024)
+    s.set_str(solv.SOLVABLE_SUMMARY, 'Synthetic package {}'.format(name))
+    return s
+
+
+def write_repo(repo, path):
+    repo.internalize()
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    f = solv.xfopen(path, 'w')
+    repo.write(f)
+    f.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate a synthetic solv cache')
+    parser.add_argument('root', help='output dir')
+    parser.add_argument('--repos', type=int, default=10, help='number of ORN repos')
+    parser.add_argument('--packages', type=int, default=50, help='packages per repo')
+    parser.add_argument('--versions', type=int, default=3, help='max versions per package')
+    parser.add_argument('--system', type=int, default=1000, help='installed system packages')
+    parser.add_argument('--installed', type=float, default=0.1,
+                        help='share of ORN packages that are installed')
+    parser.add_argument('--shared', type=float, default=0.2,
+                        help='share of packages also published in other repos')
+    parser.add_argument('--arch', default='armv7hl')
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    pool = solv.Pool()
+    pool.setarch(args.arch)
+
+    names = []
+    aliases = ['{}user{}'.format(REPO_PREFIX, i) for i in range(args.repos)]
+    installed = {}
+    total = 0
+
+    for alias in aliases:
+        repo = pool.add_repo(alias)
+        for _ in range(args.packages):
+            if names and rng.random() < args.shared:
+                name = rng.choice(names)
+            else:
+                name = random_name(rng)
+                names.append(name)
+            arch = args.arch if rng.random() < 0.8 else 'noarch'
+            for v in range(rng.randint(1, args.versions)):
+                evr = '{}.{}.{}-1'.format(rng.randint(0, 3), rng.randint(0, 20), v)
+                add_package(repo, name, evr, arch, rng)
+                total += 1
+                if name not in installed and rng.random() < args.installed:
+                    installed[name] = (evr, arch)
+        write_repo(repo, os.path.join(args.root, alias, 'solv'))
+
+    system = pool.add_repo('@System')
+    for i in range(args.system):
+        add_package(system, 'system-package-{}'.format(i), '1.0-1', args.arch, rng)
+    for name, (evr, arch) in installed.items():
+        add_package(system, name, evr, arch, rng)
+    write_repo(system, os.path.join(args.root, '@System', 'solv'))
+
+    with open(os.path.join(args.root, 'ssu.ini'), 'w') as f:
+        f.write('[General]\narch={}\nrelease=3.0.0.0\n'.format(args.arch))
+        f.write('\n[repository-urls]\n')
+        for alias in aliases:
+            f.write('{}={}\n'.format(alias, REPO_URL.format(alias[len(REPO_PREFIX):])))
+
+    print('Generated {} repos with {} solvables and {} installed packages in {}'.format(
+        len(aliases), total, args.system + len(installed), args.root))
+
+
+if __name__ == '__main__':
+    main()
@@ -1,7 +1,5 @@
 #include "orn.h"
 
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QStandardPaths>
 #include <QDir>
 
@@ -10,18 +8,6 @@
 namespace Orn
 {
 
-QList<quint32> toIntList(const QJsonValue &value)
-{
-    auto array = value.toArray();
-    QString tidKey(QStringLiteral("tid"));
-    QList<quint32> list;
-    for (const QJsonValue &v: array)
-    {
-        list << toUint(v.toObject()[tidKey]);
-    }
-    return list;
-}
-
 QString locate(const QString &filename)
 {
     auto dir = QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
@@ -1,5 +1,7 @@
 #include "orn_plugin.h"
 #include "ornapirequest.h"
+#include "ornapidispatcher.h"
+#include "ornapistats.h"
 #include "ornclient.h"
 #include "ornpm.h"
 #include "ornapplication.h"
@@ -12,14 +14,18 @@
 #include "orncategoryappsmodel.h"
 #include "ornrepomodel.h"
 #include "orninstalledappsmodel.h"
+#include "ornupdatesmodel.h"
+#include "ornavailablepackagesmodel.h"
 #include "ornproxymodel.h"
 #include "orncommentsmodel.h"
 #include "orncategoriesmodel.h"
 #include "ornbookmarksmodel.h"
-//#include "ornbackup.h"
+#include "ornbackup.h"
+#include "orntransactionjournal.h"
 
 #include <qqml.h>
 #include <QNetworkAccessManager>
+#include <QNetworkRequest>
 
 /// The global pointer to the instance of network access manager
 QNetworkAccessManager *ornNetworkAccessManager = nullptr;
@@ -27,7 +33,10 @@ QNetworkAccessManager *ornNetworkAccessManager = nullptr;
 void OrnPlugin::registerTypes(const char *uri)
 {
     Q_ASSERT_X(!ornNetworkAccessManager, Q_FUNC_INFO, "ornNetworkAccessManager is already initialized");
+    // The API requests have their own manager with the cache in the network thread
     ornNetworkAccessManager = new QNetworkAccessManager();
+    // Pay the DNS, TCP and TLS handshakes while the QML is being loaded
+    OrnApiDispatcher::instance()->warmUp();
 
     qmlRegisterType<OrnApiRequest>        (uri, 1, 0, "OrnApiRequest");
     qmlRegisterType<OrnApplication>       (uri, 1, 0, "OrnApplication");
@@ -40,15 +49,24 @@ void OrnPlugin::registerTypes(const char *uri)
     qmlRegisterType<OrnCategoryAppsModel> (uri, 1, 0, "OrnCategoryAppsModel");
     qmlRegisterType<OrnRepoModel>         (uri, 1, 0, "OrnRepoModel");
     qmlRegisterType<OrnInstalledAppsModel>(uri, 1, 0, "OrnInstalledAppsModel");
+    qmlRegisterType<OrnUpdatesModel>      (uri, 1, 0, "OrnUpdatesModel");
+    qmlRegisterType<OrnAvailablePackagesModel>(uri, 1, 0, "OrnAvailablePackagesModel");
     qmlRegisterType<OrnProxyModel>        (uri, 1, 0, "OrnProxyModel");
     qmlRegisterType<OrnCommentsModel>     (uri, 1, 0, "OrnCommentsModel");
     qmlRegisterType<OrnCategoriesModel>   (uri, 1, 0, "OrnCategoriesModel");
     qmlRegisterType<OrnBookmarksModel>    (uri, 1, 0, "OrnBookmarksModel");
-//    qmlRegisterType<OrnBackup>            (uri, 1, 0, "OrnBackup");
+    qmlRegisterType<OrnBackup>            (uri, 1, 0, "OrnBackup");
 
     qmlRegisterSingletonType<OrnClient>   (uri, 1, 0, "OrnClient", OrnClient::qmlInstance);
     qmlRegisterSingletonType<OrnPm>       (uri, 1, 0, "OrnPm",     OrnPm::qmlInstance);
+    qmlRegisterSingletonType<OrnApiStats> (uri, 1, 0, "OrnApiStats", OrnApiStats::qmlInstance);
+
+    qmlRegisterUncreatableType<OrnTransactionJournal>(uri, 1, 0, "OrnTransactionJournal",
+                                                      QStringLiteral("Use OrnPm.journal"));
 
     qRegisterMetaType<QList<OrnInstalledPackage>>();
     qRegisterMetaType<QList<OrnPackageVersion>>();
+    qRegisterMetaType<QList<OrnUpdatablePackage>>();
+    qRegisterMetaType<OrnInstallPreview>();
+    qRegisterMetaType<OrnPackageVersionMap>();
 }
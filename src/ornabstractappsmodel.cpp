@@ -5,7 +5,7 @@
 OrnAbstractAppsModel::OrnAbstractAppsModel(bool fetchable, QObject *parent) :
     OrnAbstractListModel(fetchable, parent)
 {
-
+    mApiRequest->setItemDecoder(&OrnAbstractListModel::decodeItem<OrnAppListItem>);
 }
 
 QVariant OrnAbstractAppsModel::data(const QModelIndex &index, int role) const
@@ -34,7 +34,7 @@ QHash<int, QByteArray> OrnAbstractAppsModel::roleNames() const
     return { { DataRole, "appData" } };
 }
 
-void OrnAbstractAppsModel::onJsonReady(const QJsonDocument &jsonDoc)
+void OrnAbstractAppsModel::onJsonReady(const QByteArray &json)
 {
-    OrnAbstractListModel::processReply<OrnAppListItem>(jsonDoc);
+    OrnAbstractListModel::processReply<OrnAppListItem>(json);
 }
@@ -26,7 +26,7 @@ public:
 
     // OrnAbstractListModel interface
 protected slots:
-    void onJsonReady(const QJsonDocument &jsonDoc);
+    void onJsonReady(const QByteArray &json);
 };
 
 #endif // ORNABSTRACTAPPSMODEL_H
@@ -2,16 +2,42 @@
 #include "ornapirequest.h"
 
 #include <QNetworkReply>
+#include <QCryptographicHash>
 #include <QDebug>
 
+#include <limits>
+
+// The maximum number of pages requested ahead of the view
+#define MAX_PREFETCH_DEPTH 3
+
 OrnAbstractListModel::OrnAbstractListModel(bool fetchable, QObject *parent) :
     QAbstractListModel(parent),
     mFetchable(fetchable),
     mCanFetchMore(true),
     mPage(0),
-    mApiRequest(new OrnApiRequest(this))
+    mApiRequest(new OrnApiRequest(this)),
+    mPageItems(0),
+    mSkipPage(false),
+    mLoading(false),
+    mPageLimit(std::numeric_limits<quint32>::max()),
+    mPageLatency(0),
+    mFetchInterval(0),
+    mStaleRequest(new OrnApiRequest(this)),
+    mStaleLoading(false),
+    mStaleFirst(0),
+    mStaleCount(0)
 {
+    // The stored copy is not needed after the fresh reply has come
+    connect(mApiRequest, &OrnApiRequest::jsonReady, this, &OrnAbstractListModel::onFreshReply);
+    connect(mApiRequest, &OrnApiRequest::itemsReady, this, &OrnAbstractListModel::onFreshReply);
     connect(mApiRequest, &OrnApiRequest::jsonReady, this, &OrnAbstractListModel::onJsonReady);
+    connect(mApiRequest, &OrnApiRequest::itemsReady, this, &OrnAbstractListModel::processItems);
+    connect(mApiRequest, &OrnApiRequest::failed, this, &OrnAbstractListModel::onRequestFailed);
+
+    mStaleRequest->setMaxRetries(0);
+    connect(mStaleRequest, &OrnApiRequest::itemsReady, this, &OrnAbstractListModel::onStaleItems);
+    connect(mStaleRequest, &OrnApiRequest::jsonReady, this, &OrnAbstractListModel::onStaleJson);
+    connect(mStaleRequest, &OrnApiRequest::failed, this, &OrnAbstractListModel::onStaleFailed);
 }
 
 OrnApiRequest *OrnAbstractListModel::apiRequest() const
@@ -28,7 +54,17 @@ void OrnAbstractListModel::reset()
     mCanFetchMore = true;
     mPage = 0;
     mApiRequest->reset();
+    mStaleRequest->reset();
+    this->cancelPrefetch();
+    mStaleLoading = false;
+    this->clearStale();
     mPrevReplyHash.clear();
+    mPageItems = 0;
+    mSkipPage = false;
+    mLoading = false;
+    mPageLimit = std::numeric_limits<quint32>::max();
+    mLatencyTimer.invalidate();
+    mFetchTimer.invalidate();
     this->endResetModel();
     // Delete data only after reset finished
     qDeleteAll(d);
@@ -36,18 +72,535 @@ void OrnAbstractListModel::reset()
 
 void OrnAbstractListModel::apiCall(const QString &resource, QUrlQuery query)
 {
-    auto url = OrnApiRequest::apiUrl(resource);
+    if (!mFetchable)
+    {
+        auto url = OrnApiRequest::apiUrl(resource);
+        if (!query.isEmpty())
+        {
+            url.setQuery(query);
+        }
+        auto request = OrnApiRequest::networkRequest();
+        request.setUrl(url);
+        this->loadStale(request);
+        mApiRequest->run(request);
+        return;
+    }
+
+    if (mLoading)
+    {
+        qDebug() << "Page" << mPage << "is already loading";
+        return;
+    }
+    mResource = resource;
+    mQuery = query;
+    mLoading = true;
+
+    // Measure how fast the view reads the pages
+    if (mFetchTimer.isValid())
+    {
+        auto interval = mFetchTimer.restart();
+        mFetchInterval = mFetchInterval ? (mFetchInterval * 3 + interval) / 4 : interval;
+    }
+    else
+    {
+        mFetchTimer.start();
+    }
+
+    auto it = mPrefetches.find(mPage);
+    if (it == mPrefetches.end())
+    {
+        auto request = this->pageRequest(mPage);
+        mLatencyTimer.start();
+        this->loadStale(request);
+        mApiRequest->run(request);
+        return;
+    }
+
+    qDebug() << "Using prefetched page" << mPage;
+    if (it->finished)
+    {
+        auto prefetch = *it;
+        mPrefetches.erase(it);
+        prefetch.request->deleteLater();
+        this->processItems(prefetch.items, prefetch.json, true);
+        return;
+    }
+    // Insert the items received so far and wait for the rest
+    it->wanted = true;
+    it->request->setPriority(OrnApiRequest::VisiblePriority);
+    if (!it->items.isEmpty())
+    {
+        auto items = it->items;
+        auto json = it->json;
+        it->items.clear();
+        it->json.clear();
+        this->processItems(items, json, false);
+    }
+}
+
+void OrnAbstractListModel::processItems(const QObjectList &items, const QByteArrayList &json, bool last)
+{
+    if (mStaleCount == 0)
+    {
+        this->addItems(items, json, last);
+        return;
+    }
+
+    // Revalidating the stored copy of the page
+    for (const auto &item : items)
+    {
+        item->setParent(this);
+    }
+    mFreshItems.append(items);
+    mFreshJson.append(json);
+    if (last)
+    {
+        auto freshItems = mFreshItems;
+        auto freshJson = mFreshJson;
+        mFreshItems.clear();
+        mFreshJson.clear();
+        this->addItems(freshItems, freshJson, true);
+    }
+}
+
+void OrnAbstractListModel::addItems(const QObjectList &items, const QByteArrayList &json, bool last)
+{
+    if (!items.isEmpty() && mPageItems == 0)
+    {
+        // The first items of a page
+        if (!mFetchable)
+        {
+            mCanFetchMore = false;
+        }
+        else
+        {
+            // An ugly patch for some models with repeating data (search model)
+            auto pageHash = QCryptographicHash::hash(json.first(), QCryptographicHash::Md5);
+            if (mPrevReplyHash == pageHash)
+            {
+                qDebug() << "Current reply is equal to the previous one. "
+                            "Considering the model has fetched all data";
+                mCanFetchMore = false;
+                mSkipPage = true;
+            }
+            mPrevReplyHash = pageHash;
+        }
+        if (!mSkipPage)
+        {
+            ++mPage;
+        }
+    }
+    mPageItems += items.size();
+
+    if (mStaleCount > 0)
+    {
+        // Update the stored copy in place
+        if (mSkipPage)
+        {
+            this->updateRows(mStaleFirst, mStaleCount, QObjectList(), mStaleJson, QByteArrayList());
+            qDeleteAll(items);
+        }
+        else
+        {
+            this->updateRows(mStaleFirst, mStaleCount, items, mStaleJson, json);
+        }
+        this->clearStale();
+    }
+    else if (mSkipPage)
+    {
+        qDeleteAll(items);
+    }
+    else if (!items.isEmpty())
+    {
+        for (const auto &item: items)
+        {
+            item->setParent(this);
+        }
+        // Insert the whole batch at once
+        auto row = mData.size();
+        this->beginInsertRows(QModelIndex(), row, row + items.size() - 1);
+        mData.append(items);
+        qDebug() << items.size() << "items have been added to the model";
+        this->endInsertRows();
+    }
+
+    if (last)
+    {
+        auto skipped = mSkipPage;
+        if (mPageItems == 0)
+        {
+            qDebug() << "Reply is empty, the model has fetched all data";
+            mCanFetchMore = false;
+        }
+        mPageItems = 0;
+        mSkipPage = false;
+        mLoading = false;
+        if (mLatencyTimer.isValid())
+        {
+            this->updatePageLatency(mLatencyTimer.elapsed());
+            mLatencyTimer.invalidate();
+        }
+        this->schedulePrefetch();
+        if (!skipped)
+        {
+            emit this->replyProcessed();
+        }
+    }
+}
+
+void OrnAbstractListModel::onFreshReply()
+{
+    if (mStaleLoading)
+    {
+        mStaleRequest->reset();
+        mStaleLoading = false;
+    }
+}
+
+void OrnAbstractListModel::onRequestFailed()
+{
+    mLoading = false;
+    mLatencyTimer.invalidate();
+    mPageItems = 0;
+    mSkipPage = false;
+    if (mStaleCount == 0)
+    {
+        // Let the view request the page again
+        return;
+    }
+
+    qDebug() << "Could not revalidate the page, keeping the stored copy";
+    if (mStaleLoading)
+    {
+        mStaleRequest->reset();
+        mStaleLoading = false;
+    }
     if (mFetchable)
     {
-        query.addQueryItem(QStringLiteral("page"), QString::number(mPage));
+        mPrevReplyHash = QCryptographicHash::hash(mStaleJson.first(), QCryptographicHash::Md5);
+        ++mPage;
+    }
+    else
+    {
+        mCanFetchMore = false;
     }
-    if (!query.isEmpty())
+    this->clearStale();
+    emit this->replyProcessed();
+}
+
+void OrnAbstractListModel::loadStale(QNetworkRequest request)
+{
+    if (mStaleLoading || mStaleCount > 0)
     {
-        url.setQuery(query);
+        return;
     }
+    // Fails at once if the page is not stored
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysCache);
+    mStaleRequest->setItemDecoder(mApiRequest->itemDecoder());
+    mStaleLoading = true;
+    mStaleRequest->run(request);
+}
+
+void OrnAbstractListModel::clearStale()
+{
+    mStaleCount = 0;
+    mStaleJson.clear();
+    qDeleteAll(mFreshItems);
+    mFreshItems.clear();
+    mFreshJson.clear();
+}
+
+void OrnAbstractListModel::onStaleItems(const QObjectList &items, const QByteArrayList &json, bool last)
+{
+    if (!mStaleLoading)
+    {
+        qDeleteAll(items);
+        return;
+    }
+    if (last)
+    {
+        mStaleLoading = false;
+    }
+    if (items.isEmpty())
+    {
+        return;
+    }
+
+    for (const auto &item : items)
+    {
+        item->setParent(this);
+    }
+    if (mStaleCount == 0)
+    {
+        mStaleFirst = mData.size();
+    }
+    auto row = mData.size();
+    this->beginInsertRows(QModelIndex(), row, row + items.size() - 1);
+    mData.append(items);
+    mStaleJson.append(json);
+    mStaleCount += items.size();
+    qDebug() << items.size() << "stored items have been added to the model";
+    this->endInsertRows();
+}
+
+void OrnAbstractListModel::onStaleJson(const QByteArray &json)
+{
+    if (!mStaleLoading)
+    {
+        return;
+    }
+    mStaleLoading = false;
+    // The models decoding whole replies update their rows themselves
+    if (!mApiRequest->isStreaming())
+    {
+        this->onJsonReady(json);
+    }
+}
+
+void OrnAbstractListModel::onStaleFailed()
+{
+    mStaleLoading = false;
+}
+
+void OrnAbstractListModel::updateRows(int first, int count, const QObjectList &items,
+                                      const QByteArrayList &oldKeys, const QByteArrayList &newKeys)
+{
+    // The rows could be removed while the fresh data was loading
+    count = qMin(count, mData.size() - first);
+    int n = qMin(count, oldKeys.size());
+    int m = items.size();
+
+    // The lengths of the longest common subsequences of the key suffixes
+    QVector<int> lcs((n + 1) * (m + 1), 0);
+    auto at = [&lcs, m](int i, int j) -> int & { return lcs[i * (m + 1) + j]; };
+    for (int i = n - 1; i >= 0; --i)
+    {
+        for (int j = m - 1; j >= 0; --j)
+        {
+            at(i, j) = oldKeys[i] == newKeys[j] ?
+                        at(i + 1, j + 1) + 1 : qMax(at(i + 1, j), at(i, j + 1));
+        }
+    }
+
+    int i = 0;
+    int j = 0;
+    int row = first;
+    int kept = 0;
+    int changed = 0;
+    while (i < n || j < m)
+    {
+        if (i < n && j < m && oldKeys[i] == newKeys[j])
+        {
+            // The row has not changed
+            delete items[j];
+            ++i;
+            ++j;
+            ++row;
+            ++kept;
+            continue;
+        }
+
+        // Collect the run of the removed and inserted rows
+        int removed = 0;
+        int inserted = 0;
+        int from = j;
+        while ((i + removed < n || j < m) &&
+               !(i + removed < n && j < m && oldKeys[i + removed] == newKeys[j]))
+        {
+            if (j == m || (i + removed < n && at(i + removed + 1, j) >= at(i + removed, j + 1)))
+            {
+                ++removed;
+            }
+            else
+            {
+                ++j;
+                ++inserted;
+            }
+        }
+        i += removed;
+        changed += qMax(removed, inserted);
+
+        // The changed rows are replaced in place
+        int replaced = qMin(removed, inserted);
+        for (int k = 0; k < replaced; ++k)
+        {
+            auto item = items[from + k];
+            item->setParent(this);
+            mData[row + k]->deleteLater();
+            mData[row + k] = item;
+        }
+        if (replaced > 0)
+        {
+            emit this->dataChanged(this->index(row), this->index(row + replaced - 1));
+        }
+        row += replaced;
+        if (removed > replaced)
+        {
+            int last = row + removed - replaced - 1;
+            this->beginRemoveRows(QModelIndex(), row, last);
+            for (int r = row; r <= last; ++r)
+            {
+                mData[r]->deleteLater();
+            }
+            mData.erase(mData.begin() + row, mData.begin() + last + 1);
+            this->endRemoveRows();
+        }
+        else if (inserted > replaced)
+        {
+            auto added = items.mid(from + replaced, inserted - replaced);
+            this->beginInsertRows(QModelIndex(), row, row + added.size() - 1);
+            for (int k = 0; k < added.size(); ++k)
+            {
+                added[k]->setParent(this);
+                mData.insert(row + k, added[k]);
+            }
+            this->endInsertRows();
+            row += added.size();
+        }
+    }
+    qDebug() << "Updated the stored rows:" << kept << "kept," << changed << "changed";
+}
+
+QNetworkRequest OrnAbstractListModel::pageRequest(quint32 page) const
+{
+    auto url = OrnApiRequest::apiUrl(mResource);
+    auto query = mQuery;
+    query.addQueryItem(QStringLiteral("page"), QString::number(page));
+    url.setQuery(query);
     auto request = OrnApiRequest::networkRequest();
     request.setUrl(url);
-    mApiRequest->run(request);
+    return request;
+}
+
+int OrnAbstractListModel::prefetchDepth() const
+{
+    if (mPageLatency == 0 || mFetchInterval == 0)
+    {
+        return 1;
+    }
+    // Enough pages to hide the loading time at the current reading speed
+    auto depth = int((mPageLatency + mFetchInterval - 1) / mFetchInterval);
+    return qBound(1, depth, MAX_PREFETCH_DEPTH);
+}
+
+void OrnAbstractListModel::schedulePrefetch()
+{
+    // Only the streaming requests keep the decoded items until they are needed
+    if (!mFetchable || !mCanFetchMore || mResource.isEmpty() || !mApiRequest->isStreaming())
+    {
+        return;
+    }
+    auto end = mPage + quint32(this->prefetchDepth());
+    for (auto page = mPage; page < end && page < mPageLimit; ++page)
+    {
+        if (!mPrefetches.contains(page))
+        {
+            this->prefetch(page);
+        }
+    }
+}
+
+void OrnAbstractListModel::prefetch(quint32 page)
+{
+    qDebug() << "Prefetching page" << page;
+    auto request = new OrnApiRequest(this);
+    request->setPriority(OrnApiRequest::PrefetchPriority);
+    request->setItemDecoder(mApiRequest->itemDecoder());
+    connect(request, &OrnApiRequest::itemsReady, this,
+            [this, page](const QObjectList &items, const QByteArrayList &json, bool last)
+    {
+        this->onPrefetchItems(page, items, json, last);
+    });
+    // Not an array, so the page is empty
+    connect(request, &OrnApiRequest::jsonReady, this, [this, page]()
+    {
+        this->onPrefetchItems(page, QObjectList(), QByteArrayList(), true);
+    });
+    connect(request, &OrnApiRequest::failed, this, [this, page]()
+    {
+        this->onPrefetchFailed(page);
+    });
+
+    auto &prefetch = mPrefetches[page];
+    prefetch.request = request;
+    prefetch.count = 0;
+    prefetch.finished = false;
+    prefetch.wanted = false;
+    prefetch.timer.start();
+    request->run(this->pageRequest(page));
+}
+
+void OrnAbstractListModel::onPrefetchItems(quint32 page, const QObjectList &items,
+                                           const QByteArrayList &json, bool last)
+{
+    auto it = mPrefetches.find(page);
+    if (it == mPrefetches.end())
+    {
+        qDeleteAll(items);
+        return;
+    }
+
+    it->count += items.size();
+    if (last)
+    {
+        this->updatePageLatency(it->timer.elapsed());
+        if (it->count == 0)
+        {
+            mPageLimit = qMin(mPageLimit, page);
+        }
+    }
+
+    if (it->wanted)
+    {
+        if (last)
+        {
+            it->request->deleteLater();
+            mPrefetches.erase(it);
+        }
+        this->processItems(items, json, last);
+        return;
+    }
+
+    for (const auto &item : items)
+    {
+        item->setParent(this);
+    }
+    it->items.append(items);
+    it->json.append(json);
+    it->finished = last;
+}
+
+void OrnAbstractListModel::onPrefetchFailed(quint32 page)
+{
+    auto it = mPrefetches.find(page);
+    if (it == mPrefetches.end())
+    {
+        return;
+    }
+    auto prefetch = *it;
+    mPrefetches.erase(it);
+    prefetch.request->deleteLater();
+    qDeleteAll(prefetch.items);
+    if (prefetch.wanted)
+    {
+        this->onRequestFailed();
+    }
+}
+
+void OrnAbstractListModel::cancelPrefetch()
+{
+    for (auto &prefetch : mPrefetches)
+    {
+        prefetch.request->reset();
+        prefetch.request->deleteLater();
+        qDeleteAll(prefetch.items);
+    }
+    mPrefetches.clear();
+}
+
+void OrnAbstractListModel::updatePageLatency(qint64 latency)
+{
+    mPageLatency = mPageLatency ? (mPageLatency * 3 + latency) / 4 : latency;
 }
 
 int OrnAbstractListModel::rowCount(const QModelIndex &parent) const
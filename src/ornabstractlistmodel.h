@@ -2,14 +2,16 @@
 #define ORNABSTRACTLISTMODEL_H
 
 #include <QAbstractListModel>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QUrlQuery>
-#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "ornjsonarrayreader.h"
+#include "ornjsonreader.h"
 
 #include <QDebug>
 
+class QNetworkRequest;
 class OrnApiRequest;
 
 class OrnAbstractListModel : public QAbstractListModel
@@ -30,54 +32,47 @@ signals:
 
 protected:
     void apiCall(const QString &resource, QUrlQuery query = QUrlQuery());
+    /// Replace the rows with the items with minimal changes,
+    /// the rows with the keys equal to the new ones are kept
+    void updateRows(int first, int count, const QObjectList &items,
+                    const QByteArrayList &oldKeys, const QByteArrayList &newKeys);
+    template<typename T>
+    static QObject *decodeItem(OrnJsonReader &reader)
+    {
+        // Each class of list item should implement a constructor
+        // SomeListItem(OrnJsonReader &, QObject *)
+        return new T(reader, nullptr);
+    }
+
     template<typename T>
-    void processReply(const QJsonDocument &jsonDoc)
+    void processReply(const QByteArray &json)
     {
-        auto jsonArray = jsonDoc.array();
-        if (jsonArray.size() > 0)
+        OrnJsonArrayReader arrayReader;
+        auto items = arrayReader.read(json);
+        if (arrayReader.state() != OrnJsonArrayReader::EndState)
         {
-            if (!mFetchable)
-            {
-                mCanFetchMore = false;
-            }
-            else
-            {
-                // An ugly patch for some models with repeating data (search model)
-                auto replyHash = QCryptographicHash::hash(
-                            jsonDoc.toJson(), QCryptographicHash::Md5);
-                if (mPrevReplyHash == replyHash)
-                {
-                    qDebug() << "Current reply is equal to the previous one. "
-                                "Considering the model has fetched all data";
-                    mCanFetchMore = false;
-                    return;
-                }
-                mPrevReplyHash = replyHash;
-            }
-            QObjectList list;
-            for (const QJsonValueRef &jsonValue: jsonArray)
-            {
-                // Each class of list item should implement a constructor
-                // SomeListItem(const QJsonValue &, QObject *)
-                list << new T(jsonValue.toObject(), this);
-            }
-            auto row = mData.size();
-            this->beginInsertRows(QModelIndex(), row, row + list.size() - 1);
-            mData.append(list);
-            ++mPage;
-            qDebug() << list.size() << "items have been added to the model";
-            this->endInsertRows();
+            items.clear();
         }
-        else
+        QObjectList list;
+        for (const auto &item: items)
         {
-            qDebug() << "Reply is empty, the model has fetched all data";
-            mCanFetchMore = false;
+            OrnJsonReader reader(item);
+            list << decodeItem<T>(reader);
         }
-        emit this->replyProcessed();
+        this->processItems(list, items, true);
     }
 
 protected slots:
-    virtual void onJsonReady(const QJsonDocument &jsonDoc) = 0;
+    /// Insert the decoded items of a page while it arrives
+    void processItems(const QObjectList &items, const QByteArrayList &json, bool last);
+    virtual void onJsonReady(const QByteArray &json) = 0;
+
+private slots:
+    void onFreshReply();
+    void onRequestFailed();
+    void onStaleItems(const QObjectList &items, const QByteArrayList &json, bool last);
+    void onStaleJson(const QByteArray &json);
+    void onStaleFailed();
 
 protected:
     bool    mFetchable;
@@ -87,7 +82,61 @@ protected:
     OrnApiRequest *mApiRequest;
 
 private:
+    /// A page requested ahead of the view
+    struct Prefetch
+    {
+        OrnApiRequest *request;
+        // The items kept until the view asks for the page
+        QObjectList items;
+        QByteArrayList json;
+        int count;
+        bool finished;
+        // The view has asked for the page, the items go straight to the model
+        bool wanted;
+        QElapsedTimer timer;
+    };
+
+    void addItems(const QObjectList &items, const QByteArrayList &json, bool last);
+    void loadStale(QNetworkRequest request);
+    void clearStale();
+    QNetworkRequest pageRequest(quint32 page) const;
+    int prefetchDepth() const;
+    void schedulePrefetch();
+    void prefetch(quint32 page);
+    void onPrefetchItems(quint32 page, const QObjectList &items, const QByteArrayList &json, bool last);
+    void onPrefetchFailed(quint32 page);
+    void cancelPrefetch();
+    void updatePageLatency(qint64 latency);
+
     QByteArray mPrevReplyHash;
+    // The number of items received for the current page
+    int mPageItems;
+    bool mSkipPage;
+
+    QString mResource;
+    QUrlQuery mQuery;
+    // The page requested by the view is being loaded
+    bool mLoading;
+    // The first page known to be empty
+    quint32 mPageLimit;
+    // Moving averages of the page loading time and of the time
+    // between the page requests of the view in ms
+    qint64 mPageLatency;
+    qint64 mFetchInterval;
+    QElapsedTimer mLatencyTimer;
+    QElapsedTimer mFetchTimer;
+    QHash<quint32, Prefetch> mPrefetches;
+
+    // Loads the stored copy of the requested page from the cache
+    OrnApiRequest *mStaleRequest;
+    bool mStaleLoading;
+    // The rows of the stored copy shown until the fresh page arrives
+    int mStaleFirst;
+    int mStaleCount;
+    QByteArrayList mStaleJson;
+    // The fresh page is collected to update the stored rows at once
+    QObjectList mFreshItems;
+    QByteArrayList mFreshJson;
 
     // QAbstractItemModel interface
 public:
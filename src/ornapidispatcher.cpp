@@ -0,0 +1,335 @@
+#include "ornapidispatcher.h"
+#include "ornapirequest.h"
+#include "ornapiworker.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QThread>
+#include <QPointer>
+#include <QDateTime>
+
+#include <QDebug>
+
+// The maximum number of simultaneous replies for a host
+#define MAX_HOST_REPLIES 4
+
+extern QNetworkAccessManager *ornNetworkAccessManager;
+
+static OrnApiDispatcher *gDispatcher = nullptr;
+
+OrnApiDispatcher::OrnApiDispatcher(QObject *parent)
+    : QObject(parent)
+    , mThread(new QThread(this))
+    , mWorker(new OrnApiWorker(this->thread()))
+{
+    qRegisterMetaType<QNetworkRequest>();
+    qRegisterMetaType<QObjectList>("QObjectList");
+    qRegisterMetaType<QByteArrayList>("QByteArrayList");
+    qRegisterMetaType<OrnItemDecoder>("OrnItemDecoder");
+    qRegisterMetaType<OrnApiBatchHash>("OrnApiBatchHash");
+    qRegisterMetaType<OrnApiTiming>("OrnApiTiming");
+
+    mThread->setObjectName(QStringLiteral("OrnApiThread"));
+    mWorker->moveToThread(mThread);
+    connect(mThread, &QThread::finished, mWorker, &QObject::deleteLater);
+    connect(qApp, &QCoreApplication::aboutToQuit, [this]()
+    {
+        mThread->quit();
+        mThread->wait();
+    });
+
+    connect(this, &OrnApiDispatcher::warmUpConnection, mWorker, &OrnApiWorker::warmUp);
+    connect(this, &OrnApiDispatcher::startReply, mWorker, &OrnApiWorker::get);
+    connect(this, &OrnApiDispatcher::abortReply, mWorker, &OrnApiWorker::abort);
+    connect(this, &OrnApiDispatcher::addStream, mWorker, &OrnApiWorker::addStream);
+    connect(this, &OrnApiDispatcher::removeStream, mWorker, &OrnApiWorker::removeStream);
+    connect(mWorker, &OrnApiWorker::itemsReady, this, &OrnApiDispatcher::onItemsReady);
+    connect(mWorker, &OrnApiWorker::replyFinished, this, &OrnApiDispatcher::onReplyFinished);
+
+    mThread->start();
+}
+
+OrnApiDispatcher *OrnApiDispatcher::instance()
+{
+    if (!gDispatcher)
+    {
+        gDispatcher = new OrnApiDispatcher(ornNetworkAccessManager);
+    }
+    return gDispatcher;
+}
+
+QByteArray OrnApiDispatcher::requestKey(const QNetworkRequest &request)
+{
+    // The same URL in another language is another resource
+    auto key = request.url().toEncoded()
+            .append(' ')
+            .append(request.rawHeader(QByteArrayLiteral("Accept-Language")));
+    // Loading the stored copy must not join the network request
+    if (request.attribute(QNetworkRequest::CacheLoadControlAttribute).toInt() == QNetworkRequest::AlwaysCache)
+    {
+        key.append(QByteArrayLiteral(" cached"));
+    }
+    return key;
+}
+
+bool OrnApiDispatcher::get(const QNetworkRequest &request, OrnApiRequest *receiver)
+{
+    Q_ASSERT(receiver);
+    if (mReceivers.contains(receiver))
+    {
+        return false;
+    }
+
+    auto key = OrnApiDispatcher::requestKey(request);
+    mReceivers.insert(receiver, key);
+
+    auto it = mPending.find(key);
+    if (it != mPending.end())
+    {
+        qDebug() << "Joining the pending request for" << request.url().toString();
+        it->receivers << receiver;
+        // The streams of a queued request are added when it starts
+        if (it->started && receiver->isStreaming())
+        {
+            emit this->addStream(key, quintptr(receiver), receiver->itemDecoder());
+        }
+        it->priority = qMin(it->priority, int(receiver->priority()));
+        return true;
+    }
+
+    auto &pending = mPending[key];
+    pending.request = request;
+    pending.receivers << receiver;
+    pending.priority = int(receiver->priority());
+    pending.timer.start();
+    pending.queued = QDateTime::currentMSecsSinceEpoch();
+    mQueue << key;
+    this->schedule();
+    return true;
+}
+
+void OrnApiDispatcher::cancel(OrnApiRequest *receiver)
+{
+    auto key = mReceivers.take(receiver);
+    if (key.isEmpty())
+    {
+        return;
+    }
+
+    auto it = mPending.find(key);
+    if (it == mPending.end())
+    {
+        return;
+    }
+    it->receivers.removeOne(receiver);
+    if (!it->receivers.isEmpty())
+    {
+        if (it->started && receiver->isStreaming())
+        {
+            emit this->removeStream(key, quintptr(receiver));
+        }
+        this->reprioritize(it->receivers.first());
+        return;
+    }
+
+    // Nobody else waits for the request
+    auto started = it->started;
+    auto host = it->request.url().host();
+    mPending.erase(it);
+    emit this->abortReply(key);
+    if (!started)
+    {
+        mQueue.removeOne(key);
+        return;
+    }
+    --mRunning[host];
+    this->schedule();
+}
+
+void OrnApiDispatcher::reprioritize(OrnApiRequest *receiver)
+{
+    auto it = mPending.find(mReceivers.value(receiver));
+    if (it == mPending.end() || it->started)
+    {
+        return;
+    }
+    int priority = OrnApiRequest::BackgroundPriority;
+    for (const auto &r : it->receivers)
+    {
+        priority = qMin(priority, int(r->priority()));
+    }
+    it->priority = priority;
+    this->schedule();
+}
+
+void OrnApiDispatcher::warmUp()
+{
+    emit this->warmUpConnection();
+}
+
+void OrnApiDispatcher::schedule()
+{
+    // Start the queued requests with the highest priority first,
+    // the requests of the same priority are started in FIFO order
+    bool started = true;
+    while (started && !mQueue.isEmpty())
+    {
+        started = false;
+        int bestIndex = -1;
+        int bestPriority = OrnApiRequest::BackgroundPriority + 1;
+        for (int i = 0; i < mQueue.size(); ++i)
+        {
+            const auto &pending = mPending[mQueue[i]];
+            if (pending.priority < bestPriority &&
+                mRunning.value(pending.request.url().host()) < MAX_HOST_REPLIES)
+            {
+                bestIndex = i;
+                bestPriority = pending.priority;
+            }
+        }
+        if (bestIndex != -1)
+        {
+            this->start(mQueue.takeAt(bestIndex));
+            started = true;
+        }
+    }
+}
+
+void OrnApiDispatcher::start(const QByteArray &key)
+{
+    auto &pending = mPending[key];
+    switch (pending.priority)
+    {
+    case OrnApiRequest::VisiblePriority:
+        pending.request.setPriority(QNetworkRequest::HighPriority);
+        break;
+    case OrnApiRequest::PrefetchPriority:
+        pending.request.setPriority(QNetworkRequest::NormalPriority);
+        break;
+    default:
+        pending.request.setPriority(QNetworkRequest::LowPriority);
+        break;
+    }
+
+    // The coalesced receivers get the most retries any of them wants
+    int retries = 0;
+    for (const auto &receiver : pending.receivers)
+    {
+        retries = qMax(retries, receiver->maxRetries());
+    }
+    pending.request.setAttribute(OrnApiWorker::RetriesAttribute, retries);
+
+    auto url = pending.request.url();
+    qDebug() << "Fetching data from" << url.toString() << "with priority" << pending.priority;
+    ++mRunning[url.host()];
+    pending.started = true;
+    pending.queueWait = pending.timer.nsecsElapsed() / 1000000.0;
+    emit this->startReply(key, pending.request);
+    // Queued after startReply(), so the job exists in the worker
+    for (const auto &receiver : pending.receivers)
+    {
+        if (receiver->isStreaming())
+        {
+            emit this->addStream(key, quintptr(receiver), receiver->itemDecoder());
+        }
+    }
+}
+
+void OrnApiDispatcher::onItemsReady(const QByteArray &key, quintptr receiver,
+                                    const QObjectList &items, const QByteArrayList &json)
+{
+    auto request = reinterpret_cast<OrnApiRequest *>(receiver);
+    // The receiver could be cancelled while the items were on the way
+    if (mReceivers.value(request) != key)
+    {
+        qDeleteAll(items);
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    emit request->itemsReady(items, json, false);
+    // The receiver could cancel the request while handling the items
+    auto it = mPending.find(key);
+    if (it != mPending.end())
+    {
+        it->deliver += timer.nsecsElapsed() / 1000000.0;
+    }
+}
+
+void OrnApiDispatcher::onReplyFinished(const QByteArray &key, bool ok, const QByteArray &body,
+                                       const OrnApiBatchHash &batches, const OrnApiTiming &timing)
+{
+    auto it = mPending.find(key);
+    if (it == mPending.end() || !it->started)
+    {
+        // The request was cancelled
+        for (const auto &batch : batches)
+        {
+            qDeleteAll(batch.items);
+        }
+        return;
+    }
+
+    auto pending = *it;
+    mPending.erase(it);
+    --mRunning[pending.request.url().host()];
+    for (const auto &receiver : pending.receivers)
+    {
+        mReceivers.remove(receiver);
+    }
+    this->schedule();
+
+    // A receiver could be deleted by another one while handling the reply
+    QList<QPointer<OrnApiRequest>> receivers;
+    for (const auto &receiver : pending.receivers)
+    {
+        receivers << receiver;
+    }
+
+    auto stats = timing;
+    stats.started = pending.queued;
+    stats.queueWait = pending.queueWait;
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!ok)
+    {
+        for (const auto &receiver : receivers)
+        {
+            if (receiver)
+            {
+                emit receiver->failed();
+            }
+        }
+        stats.total = pending.timer.nsecsElapsed() / 1000000.0;
+        OrnApiStats::instance()->record(stats);
+        return;
+    }
+
+    auto rest = batches;
+    for (const auto &receiver : receivers)
+    {
+        auto batch = rest.take(quintptr(receiver.data()));
+        if (!receiver)
+        {
+            continue;
+        }
+        if (batches.contains(quintptr(receiver.data())))
+        {
+            emit receiver->itemsReady(batch.items, batch.json, true);
+        }
+        else
+        {
+            emit receiver->jsonReady(body);
+        }
+    }
+    // The batches of the deleted receivers
+    for (const auto &batch : rest)
+    {
+        qDeleteAll(batch.items);
+    }
+
+    stats.deliver = pending.deliver + timer.nsecsElapsed() / 1000000.0;
+    stats.total = pending.timer.nsecsElapsed() / 1000000.0;
+    OrnApiStats::instance()->record(stats);
+}
@@ -0,0 +1,89 @@
+#ifndef ORNAPIDISPATCHER_H
+#define ORNAPIDISPATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QNetworkRequest>
+#include <QElapsedTimer>
+
+#include "ornapiworker.h"
+
+class QThread;
+class OrnApiRequest;
+
+/**
+ * @brief The shared layer under OrnApiRequest::run()
+ * Identical GET requests running at the same time are coalesced,
+ * so every unique request is downloaded only once and the reply
+ * is delivered to all the waiting OrnApiRequest objects.
+ * Requests are started by their priority within a per-host budget.
+ * The replies are read and decoded by OrnApiWorker in the network thread,
+ * the items of array replies are passed to the streaming receivers
+ * in batches while the data arrives.
+ */
+class OrnApiDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static OrnApiDispatcher *instance();
+
+    /// Returns false if the receiver is already waiting for a reply
+    bool get(const QNetworkRequest &request, OrnApiRequest *receiver);
+    void cancel(OrnApiRequest *receiver);
+    /// Apply the changed priority of the receiver to its queued request
+    void reprioritize(OrnApiRequest *receiver);
+    /// Connect to the API host in the network thread before the first request
+    void warmUp();
+
+signals:
+    void warmUpConnection();
+    void startReply(const QByteArray &key, const QNetworkRequest &request);
+    void abortReply(const QByteArray &key);
+    void addStream(const QByteArray &key, quintptr receiver, OrnItemDecoder decoder);
+    void removeStream(const QByteArray &key, quintptr receiver);
+
+private slots:
+    void onItemsReady(const QByteArray &key, quintptr receiver,
+                      const QObjectList &items, const QByteArrayList &json);
+    void onReplyFinished(const QByteArray &key, bool ok, const QByteArray &body,
+                         const OrnApiBatchHash &batches, const OrnApiTiming &timing);
+
+private:
+    explicit OrnApiDispatcher(QObject *parent = nullptr);
+
+    static QByteArray requestKey(const QNetworkRequest &request);
+    void schedule();
+    void start(const QByteArray &key);
+
+    struct Pending
+    {
+        Pending() : started(false), priority(0), queued(0), queueWait(0.0), deliver(0.0) {}
+
+        QNetworkRequest request;
+        bool started;
+        QList<OrnApiRequest *> receivers;
+        // The highest priority of the receivers
+        int priority;
+        // Measures the time since queuing
+        QElapsedTimer timer;
+        qint64 queued;
+        qreal queueWait;
+        qreal deliver;
+    };
+
+    QThread *mThread;
+    OrnApiWorker *mWorker;
+
+    // <request key, pending request>
+    QHash<QByteArray, Pending> mPending;
+    // <receiver, request key>
+    QHash<OrnApiRequest *, QByteArray> mReceivers;
+    // Keys of the requests waiting for the budget in FIFO order
+    QList<QByteArray> mQueue;
+    // <host, running replies>
+    QHash<QString, int> mRunning;
+};
+
+#endif // ORNAPIDISPATCHER_H
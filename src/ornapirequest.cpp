@@ -1,8 +1,8 @@
 #include "ornapirequest.h"
+#include "ornapidispatcher.h"
 
 #include <QNetworkRequest>
 #include <QNetworkReply>
-#include <QJsonParseError>
 
 const QString OrnApiRequest::apiUrlPrefix(QStringLiteral("https://openrepos.net/api/v1/"));
 const QByteArray OrnApiRequest::langName(QByteArrayLiteral("Accept-Language"));
@@ -10,33 +10,79 @@ const QByteArray OrnApiRequest::langValue(QLocale::system().name().left(2).toUtf
 const QByteArray OrnApiRequest::platformName(QByteArrayLiteral("Warehouse-Platform"));
 const QByteArray OrnApiRequest::platformValue(QByteArrayLiteral("SailfishOS"));
 
+#define DEFAULT_MAX_RETRIES 3
+
 extern QNetworkAccessManager *ornNetworkAccessManager;
 
 OrnApiRequest::OrnApiRequest(QObject *parent) :
     QObject(parent),
-    mNetworkReply(0)
+    mNetworkReply(0),
+    mPriority(VisiblePriority),
+    mMaxRetries(DEFAULT_MAX_RETRIES),
+    mItemDecoder(nullptr)
 {
 
 }
 
 OrnApiRequest::~OrnApiRequest()
 {
+    OrnApiDispatcher::instance()->cancel(this);
     if (mNetworkReply)
     {
         mNetworkReply->deleteLater();
     }
 }
 
+OrnApiRequest::Priority OrnApiRequest::priority() const
+{
+    return mPriority;
+}
+
+void OrnApiRequest::setPriority(const Priority &priority)
+{
+    if (mPriority != priority)
+    {
+        mPriority = priority;
+        OrnApiDispatcher::instance()->reprioritize(this);
+        emit this->priorityChanged();
+    }
+}
+
+int OrnApiRequest::maxRetries() const
+{
+    return mMaxRetries;
+}
+
+void OrnApiRequest::setMaxRetries(int maxRetries)
+{
+    if (mMaxRetries != maxRetries)
+    {
+        mMaxRetries = maxRetries;
+        emit this->maxRetriesChanged();
+    }
+}
+
+bool OrnApiRequest::isStreaming() const
+{
+    return mItemDecoder != nullptr;
+}
+
+OrnItemDecoder OrnApiRequest::itemDecoder() const
+{
+    return mItemDecoder;
+}
+
+void OrnApiRequest::setItemDecoder(OrnItemDecoder decoder)
+{
+    mItemDecoder = decoder;
+}
+
 void OrnApiRequest::run(const QNetworkRequest &request)
 {
-    if (mNetworkReply)
+    if (!OrnApiDispatcher::instance()->get(request, this))
     {
         qDebug() << "Request is already running";
-        return;
     }
-    qDebug() << "Fetching data from" << request.url().toString();
-    mNetworkReply = ornNetworkAccessManager->get(request);
-    connect(mNetworkReply, &QNetworkReply::finished, this, &OrnApiRequest::onReplyFinished);
 }
 
 QUrl OrnApiRequest::apiUrl(const QString &resource)
@@ -54,33 +100,10 @@ QNetworkRequest OrnApiRequest::networkRequest()
 
 void OrnApiRequest::reset()
 {
+    OrnApiDispatcher::instance()->cancel(this);
     if (mNetworkReply)
     {
         mNetworkReply->deleteLater();
         mNetworkReply = 0;
     }
 }
-
-void OrnApiRequest::onReplyFinished()
-{
-    if (mNetworkReply->error() != QNetworkReply::NoError)
-    {
-        qDebug() << "Network request error" << mNetworkReply->error()
-                 << "-" << mNetworkReply->errorString();
-        this->reset();
-        return;
-    }
-
-    QJsonParseError error;
-    auto jsonDoc = QJsonDocument::fromJson(mNetworkReply->readAll(), &error);
-    if (error.error != QJsonParseError::NoError)
-    {
-        qCritical() << "Could not parse reply:" << error.errorString();
-        this->reset();
-        return;
-    }
-
-    emit this->jsonReady(jsonDoc);
-
-    this->reset();
-}
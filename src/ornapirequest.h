@@ -2,18 +2,47 @@
 #define ORNAPIREQUEST_H
 
 #include <QObject>
+#include <QByteArrayList>
 
 class QNetworkReply;
 class QNetworkRequest;
+class OrnJsonReader;
+
+/// Creates an item without a parent from the JSON object of the reader
+typedef QObject *(*OrnItemDecoder)(OrnJsonReader &reader);
 
 class OrnApiRequest : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
+    Q_PROPERTY(int maxRetries READ maxRetries WRITE setMaxRetries NOTIFY maxRetriesChanged)
 
 public:
+    /// Requests with a higher priority are started first
+    enum Priority
+    {
+        VisiblePriority,
+        PrefetchPriority,
+        BackgroundPriority
+    };
+    Q_ENUM(Priority)
+
     explicit OrnApiRequest(QObject *parent = nullptr);
     ~OrnApiRequest();
 
+    Priority priority() const;
+    void setPriority(const Priority &priority);
+
+    /// The number of retries with a backoff after transient network errors
+    int maxRetries() const;
+    void setMaxRetries(int maxRetries);
+
+    /// Array replies are decoded with the item decoder in the network thread
+    /// and delivered with itemsReady() while they arrive
+    bool isStreaming() const;
+    OrnItemDecoder itemDecoder() const;
+    void setItemDecoder(OrnItemDecoder decoder);
+
     void run(const QNetworkRequest &request);
 
     static QUrl apiUrl(const QString &resource);
@@ -23,15 +52,24 @@ public slots:
     void reset();
 
 signals:
-    void jsonReady(const QJsonDocument &jsonDoc);
-
-protected slots:
-    void onReplyFinished();
+    /// The whole reply, decode it with OrnJsonReader
+    void jsonReady(const QByteArray &json);
+    /// The next decoded elements of an array reply and their raw JSON
+    /// for a streaming request, the receiver takes the ownership of the items
+    void itemsReady(const QObjectList &items, const QByteArrayList &json, bool last);
+    /// The reply could not be loaded or parsed
+    void failed();
+    void priorityChanged();
+    void maxRetriesChanged();
 
 protected:
     QNetworkReply *mNetworkReply;
 
 private:
+    Priority mPriority;
+    int mMaxRetries;
+    OrnItemDecoder mItemDecoder;
+
     static const QString apiUrlPrefix;
     static const QByteArray langName;
     static const QByteArray langValue;
@@ -39,4 +77,6 @@ private:
     static const QByteArray platformValue;
 };
 
+Q_DECLARE_METATYPE(OrnItemDecoder)
+
 #endif // ORNAPIREQUEST_H
@@ -0,0 +1,205 @@
+#include "ornapistats.h"
+
+#include <QUrl>
+#include <QDateTime>
+
+#include <QDebug>
+
+// The number of the stored requests
+#define RING_SIZE 256
+#define API_PATH_PREFIX "/api/v1/"
+
+static OrnApiStats *gInstance = nullptr;
+
+OrnApiTiming::OrnApiTiming()
+    : started(0)
+    , queueWait(0.0)
+    , connect(0.0)
+    , firstByte(0.0)
+    , transfer(0.0)
+    , decode(0.0)
+    , deliver(0.0)
+    , total(0.0)
+    , bytes(0)
+    , retries(0)
+    , hedged(false)
+    , fromCache(false)
+    , ok(false)
+{
+
+}
+
+OrnApiStats::Aggregate::Aggregate()
+    : count(0)
+    , errors(0)
+    , cached(0)
+    , retries(0)
+    , hedged(0)
+    , bytes(0)
+    , queueWait(0.0)
+    , connect(0.0)
+    , firstByte(0.0)
+    , transfer(0.0)
+    , decode(0.0)
+    , deliver(0.0)
+    , total(0.0)
+    , maxTotal(0.0)
+{
+
+}
+
+OrnApiStats::OrnApiStats(QObject *parent)
+    : QObject(parent)
+    , mRing(RING_SIZE)
+    , mNext(0)
+    , mCount(0)
+{
+
+}
+
+OrnApiStats *OrnApiStats::instance()
+{
+    if (!gInstance)
+    {
+        gInstance = new OrnApiStats();
+    }
+    return gInstance;
+}
+
+QString OrnApiStats::endpoint(const QString &url)
+{
+    auto path = QUrl(url).path();
+    if (path.startsWith(QLatin1String(API_PATH_PREFIX)))
+    {
+        path.remove(0, int(sizeof(API_PATH_PREFIX)) - 1);
+    }
+    auto parts = path.split(QChar('/'));
+    for (auto &part : parts)
+    {
+        bool isNumber = false;
+        part.toULongLong(&isNumber);
+        if (isNumber)
+        {
+            part = QChar('#');
+        }
+    }
+    return parts.join(QChar('/'));
+}
+
+int OrnApiStats::count() const
+{
+    return mCount;
+}
+
+void OrnApiStats::record(const OrnApiTiming &timing)
+{
+    qDebug().nospace() << "Request timing for " << timing.url
+                       << ": queue " << timing.queueWait
+                       << " ms, connect " << timing.connect
+                       << " ms, first byte " << timing.firstByte
+                       << " ms, transfer " << timing.transfer
+                       << " ms, decode " << timing.decode
+                       << " ms, deliver " << timing.deliver
+                       << " ms, total " << timing.total
+                       << " ms, " << timing.bytes << " bytes, "
+                       << timing.retries << " retries"
+                       << (timing.hedged ? ", hedged" : "")
+                       << (timing.fromCache ? ", from cache" : "");
+
+    mRing[mNext] = timing;
+    mNext = (mNext + 1) % RING_SIZE;
+    mCount = qMin(mCount + 1, RING_SIZE);
+
+    auto &aggregate = mEndpoints[OrnApiStats::endpoint(timing.url)];
+    ++aggregate.count;
+    if (!timing.ok)
+    {
+        ++aggregate.errors;
+    }
+    if (timing.fromCache)
+    {
+        ++aggregate.cached;
+    }
+    if (timing.hedged)
+    {
+        ++aggregate.hedged;
+    }
+    aggregate.retries   += timing.retries;
+    aggregate.bytes     += timing.bytes;
+    aggregate.queueWait += timing.queueWait;
+    aggregate.connect   += timing.connect;
+    aggregate.firstByte += timing.firstByte;
+    aggregate.transfer  += timing.transfer;
+    aggregate.decode    += timing.decode;
+    aggregate.deliver   += timing.deliver;
+    aggregate.total     += timing.total;
+    aggregate.maxTotal   = qMax(aggregate.maxTotal, timing.total);
+
+    emit this->updated();
+}
+
+QVariantList OrnApiStats::timings() const
+{
+    QVariantList list;
+    list.reserve(mCount);
+    for (int i = 1; i <= mCount; ++i)
+    {
+        const auto &timing = mRing[(mNext - i + RING_SIZE) % RING_SIZE];
+        list << QVariantMap{
+            { QStringLiteral("url"),        timing.url },
+            { QStringLiteral("endpoint"),   OrnApiStats::endpoint(timing.url) },
+            { QStringLiteral("started"),    QDateTime::fromMSecsSinceEpoch(timing.started) },
+            { QStringLiteral("queueWait"),  timing.queueWait },
+            { QStringLiteral("connect"),    timing.connect },
+            { QStringLiteral("firstByte"),  timing.firstByte },
+            { QStringLiteral("transfer"),   timing.transfer },
+            { QStringLiteral("decode"),     timing.decode },
+            { QStringLiteral("deliver"),    timing.deliver },
+            { QStringLiteral("total"),      timing.total },
+            { QStringLiteral("bytes"),      timing.bytes },
+            { QStringLiteral("retries"),    timing.retries },
+            { QStringLiteral("hedged"),     timing.hedged },
+            { QStringLiteral("fromCache"),  timing.fromCache },
+            { QStringLiteral("ok"),         timing.ok }
+        };
+    }
+    return list;
+}
+
+QVariantList OrnApiStats::endpoints() const
+{
+    QVariantList list;
+    list.reserve(mEndpoints.size());
+    for (auto it = mEndpoints.cbegin(); it != mEndpoints.cend(); ++it)
+    {
+        const auto &a = it.value();
+        qreal n = a.count;
+        list << QVariantMap{
+            { QStringLiteral("endpoint"),   it.key() },
+            { QStringLiteral("count"),      a.count },
+            { QStringLiteral("errors"),     a.errors },
+            { QStringLiteral("cached"),     a.cached },
+            { QStringLiteral("retries"),    a.retries },
+            { QStringLiteral("hedged"),     a.hedged },
+            { QStringLiteral("bytes"),      a.bytes },
+            { QStringLiteral("queueWait"),  a.queueWait / n },
+            { QStringLiteral("connect"),    a.connect / n },
+            { QStringLiteral("firstByte"),  a.firstByte / n },
+            { QStringLiteral("transfer"),   a.transfer / n },
+            { QStringLiteral("decode"),     a.decode / n },
+            { QStringLiteral("deliver"),    a.deliver / n },
+            { QStringLiteral("total"),      a.total / n },
+            { QStringLiteral("maxTotal"),   a.maxTotal }
+        };
+    }
+    return list;
+}
+
+void OrnApiStats::clear()
+{
+    mRing.fill(OrnApiTiming());
+    mNext = 0;
+    mCount = 0;
+    mEndpoints.clear();
+    emit this->updated();
+}
@@ -0,0 +1,112 @@
+#ifndef ORNAPISTATS_H
+#define ORNAPISTATS_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QVariant>
+
+class QQmlEngine;
+class QJSEngine;
+
+/// The timing breakdown of an API request, the durations are in ms
+struct OrnApiTiming
+{
+    OrnApiTiming();
+
+    QString url;
+    /// Msecs since epoch when the request was queued
+    qint64 started;
+    /// Waiting for the host budget in the dispatcher
+    qreal queueWait;
+    /// DNS, TCP and TLS handshakes, 0 if the connection was reused
+    qreal connect;
+    /// From starting the reply to receiving the headers, includes connect
+    qreal firstByte;
+    /// From the headers to the last byte
+    qreal transfer;
+    /// Splitting and decoding the reply in the network thread
+    qreal decode;
+    /// Handling the reply by the receivers, mostly model inserts
+    qreal deliver;
+    /// From queuing the request to delivering the last item
+    qreal total;
+    qint64 bytes;
+    /// The number of retries after transient errors
+    int retries;
+    /// A duplicate request was sent as the reply was slow
+    bool hedged;
+    bool fromCache;
+    bool ok;
+};
+
+Q_DECLARE_METATYPE(OrnApiTiming)
+
+/**
+ * @brief Timings of the recent API requests
+ * The dispatcher records every finished request into a ring buffer,
+ * the totals are aggregated per endpoint, i.e. the API path with
+ * numeric ids replaced by '#'.
+ */
+class OrnApiStats : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY updated)
+
+public:
+    static OrnApiStats *instance();
+    static inline QObject *qmlInstance(QQmlEngine *engine, QJSEngine *scriptEngine)
+    {
+        Q_UNUSED(engine)
+        Q_UNUSED(scriptEngine)
+
+        return OrnApiStats::instance();
+    }
+
+    static QString endpoint(const QString &url);
+
+    int count() const;
+    void record(const OrnApiTiming &timing);
+
+    /// The recent requests, the newest first
+    Q_INVOKABLE QVariantList timings() const;
+    /// The averages per endpoint
+    Q_INVOKABLE QVariantList endpoints() const;
+
+public slots:
+    void clear();
+
+signals:
+    void updated();
+
+private:
+    explicit OrnApiStats(QObject *parent = nullptr);
+
+    struct Aggregate
+    {
+        Aggregate();
+
+        int count;
+        int errors;
+        int cached;
+        int retries;
+        int hedged;
+        qint64 bytes;
+        qreal queueWait;
+        qreal connect;
+        qreal firstByte;
+        qreal transfer;
+        qreal decode;
+        qreal deliver;
+        qreal total;
+        qreal maxTotal;
+    };
+
+    QVector<OrnApiTiming> mRing;
+    // The index of the next record in the ring
+    int mNext;
+    int mCount;
+    QHash<QString, Aggregate> mEndpoints;
+};
+
+#endif // ORNAPISTATS_H
@@ -0,0 +1,543 @@
+#include "ornapiworker.h"
+#include "ornjsonreader.h"
+#include "ornnetworkcache.h"
+
+#include <QThread>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTimer>
+
+#include <algorithm>
+
+#include <QDebug>
+
+#define REQUEST_PROPERTY_KEY "ornRequestKey"
+#define API_HOST "openrepos.net"
+#define SESSION_FILE_VERSION 1
+// Backoff of the retries in ms
+#define RETRY_BASE_DELAY 500
+#define RETRY_MAX_DELAY 8000
+// The circuit breaker opens after this number of consecutive transient
+// failures and serves only cached replies for the cooldown in ms
+#define BREAKER_THRESHOLD 5
+#define BREAKER_COOLDOWN 30000
+// A duplicate request is sent after the p95 time to the first byte,
+// which is measured on the recent replies of the endpoint
+#define HEDGE_MIN_SAMPLES 20
+#define HEDGE_MAX_SAMPLES 64
+#define HEDGE_MIN_DELAY 300
+
+static inline qreal msecs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000000.0;
+}
+
+static bool isTransient(QNetworkReply::NetworkError error)
+{
+    switch (error)
+    {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::UnknownServerError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void dropReply(QNetworkReply *reply)
+{
+    if (reply)
+    {
+        reply->disconnect();
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+static QString sessionFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            .append(QStringLiteral("/network/tls-session"));
+}
+
+OrnApiWorker::OrnApiWorker(QThread *targetThread, QObject *parent)
+    : QObject(parent)
+    , mTargetThread(targetThread)
+    , mManager(nullptr)
+    , mSerial(0)
+{
+
+}
+
+QNetworkAccessManager *OrnApiWorker::manager()
+{
+    if (!mManager)
+    {
+        // Create the manager in the network thread
+        mManager = new QNetworkAccessManager(this);
+        // Cache the replies separately for the language of the API requests
+        auto language = OrnApiRequest::networkRequest().rawHeader(QByteArrayLiteral("Accept-Language"));
+        mManager->setCache(new OrnNetworkCache(language, mManager));
+
+        mSslConfiguration = QSslConfiguration::defaultConfiguration();
+        // Allow reading the session ticket to store it
+        mSslConfiguration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        mSslConfiguration.setAllowedNextProtocols({ QSslConfiguration::ALPNProtocolHTTP2,
+                                                    QSslConfiguration::NextProtocolHttp1_1 });
+#endif
+        this->loadSessionTicket();
+        // Randomize the backoff jitter
+        qsrand(uint(QDateTime::currentMSecsSinceEpoch()));
+    }
+    return mManager;
+}
+
+void OrnApiWorker::warmUp()
+{
+    qDebug() << "Connecting to" << API_HOST;
+    // Resolves the host and makes the TCP and TLS handshakes,
+    // the connection is kept in the manager for the first request
+    this->manager()->connectToHostEncrypted(QStringLiteral(API_HOST), 443, mSslConfiguration);
+}
+
+void OrnApiWorker::get(const QByteArray &key, const QNetworkRequest &request)
+{
+    this->manager();
+    auto &job = mJobs[key];
+    job.request = request;
+    job.request.setSslConfiguration(mSslConfiguration);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    // Parallel requests share one connection if the server supports HTTP/2
+    job.request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+    job.maxRetries = request.attribute(RetriesAttribute, 0).toInt();
+    job.cacheOnly = request.attribute(QNetworkRequest::CacheLoadControlAttribute).toInt() ==
+            QNetworkRequest::AlwaysCache;
+    job.timer.start();
+    job.timing.url = request.url().toString();
+    if (!job.cacheOnly && this->isBreakerOpen(request.url().host()))
+    {
+        job.cacheOnly = true;
+        qDebug() << "The API is unavailable, loading" << job.timing.url << "from cache";
+    }
+    this->startReply(key, job);
+}
+
+void OrnApiWorker::abort(const QByteArray &key)
+{
+    auto it = mJobs.find(key);
+    if (it == mJobs.end())
+    {
+        return;
+    }
+    auto reply = it->reply;
+    auto hedge = it->hedge;
+    mJobs.erase(it);
+    dropReply(reply);
+    dropReply(hedge);
+}
+
+void OrnApiWorker::addStream(const QByteArray &key, quintptr receiver, OrnItemDecoder decoder)
+{
+    // The job could finish while the call was queued,
+    // the receiver gets the whole reply then
+    auto it = mJobs.find(key);
+    if (it != mJobs.end())
+    {
+        // The elements read so far are delivered with the next batch
+        it->streams.insert(receiver, { decoder, 0 });
+    }
+}
+
+void OrnApiWorker::removeStream(const QByteArray &key, quintptr receiver)
+{
+    auto it = mJobs.find(key);
+    if (it != mJobs.end())
+    {
+        it->streams.remove(receiver);
+    }
+}
+
+void OrnApiWorker::loadSessionTicket()
+{
+    QFile file(sessionFilePath());
+    if (!file.open(QFile::ReadOnly))
+    {
+        return;
+    }
+    QDataStream stream(&file);
+    quint8 version = 0;
+    qint64 expires = 0;
+    QByteArray ticket;
+    stream >> version >> expires >> ticket;
+    if (stream.status() != QDataStream::Ok || version != SESSION_FILE_VERSION)
+    {
+        qWarning() << "Could not read the TLS session file" << file.fileName();
+        return;
+    }
+    if (expires && expires < QDateTime::currentMSecsSinceEpoch() / 1000)
+    {
+        qDebug() << "The stored TLS session has expired";
+        return;
+    }
+    mSslConfiguration.setSessionTicket(ticket);
+}
+
+void OrnApiWorker::saveSessionTicket(const QSslConfiguration &configuration)
+{
+    auto ticket = configuration.sessionTicket();
+    if (ticket.isEmpty() || ticket == mSslConfiguration.sessionTicket())
+    {
+        return;
+    }
+    mSslConfiguration.setSessionTicket(ticket);
+
+    auto path = sessionFilePath();
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly))
+    {
+        qWarning() << "Could not write the TLS session file" << path;
+        return;
+    }
+    // The lifetime hint is -1 if the server did not send it
+    auto lifetime = configuration.sessionTicketLifeTimeHint();
+    qint64 expires = lifetime > 0 ? QDateTime::currentMSecsSinceEpoch() / 1000 + lifetime : 0;
+    QDataStream stream(&file);
+    stream << quint8(SESSION_FILE_VERSION) << expires << ticket;
+    file.commit();
+}
+
+QNetworkReply *OrnApiWorker::createReply(const QByteArray &key, const QNetworkRequest &request)
+{
+    auto reply = mManager->get(request);
+    reply->setProperty(REQUEST_PROPERTY_KEY, key);
+    // Emitted only if the reply has made a new connection
+    connect(reply, &QNetworkReply::encrypted, this, &OrnApiWorker::onReplyEncrypted);
+    connect(reply, &QNetworkReply::metaDataChanged, this, &OrnApiWorker::onReplyMetaDataChanged);
+    connect(reply, &QNetworkReply::readyRead, this, &OrnApiWorker::onReplyReadyRead);
+    connect(reply, &QNetworkReply::finished, this, &OrnApiWorker::onReplyFinished);
+    return reply;
+}
+
+void OrnApiWorker::startReply(const QByteArray &key, Job &job)
+{
+    auto request = job.request;
+    if (job.cacheOnly)
+    {
+        // Fails at once if the reply is not cached
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysCache);
+    }
+    job.attemptTimer.start();
+    job.reply = this->createReply(key, request);
+    job.serial = ++mSerial;
+
+    auto delay = job.cacheOnly ? 0 : this->hedgeDelay(job.timing.url);
+    if (delay > 0)
+    {
+        auto serial = job.serial;
+        QTimer::singleShot(delay, this, [this, key, serial]()
+        {
+            this->hedge(key, serial);
+        });
+    }
+}
+
+void OrnApiWorker::retry(const QByteArray &key, Job &job)
+{
+    // Exponential backoff with equal jitter
+    auto delay = qMin(RETRY_BASE_DELAY << qMin(job.attempt, 4), RETRY_MAX_DELAY);
+    delay = delay / 2 + qrand() % (delay / 2 + 1);
+    ++job.attempt;
+    qDebug() << "Retrying" << job.timing.url << "in" << delay << "ms, attempt" << job.attempt;
+
+    // The elements delivered before the error are skipped in the new reply
+    job.reply = nullptr;
+    job.reader = OrnJsonArrayReader();
+    job.items.clear();
+    job.body.clear();
+    job.timing.firstByte = 0.0;
+    auto serial = job.serial = ++mSerial;
+    QTimer::singleShot(delay, this, [this, key, serial]()
+    {
+        auto it = mJobs.find(key);
+        if (it != mJobs.end() && it->serial == serial)
+        {
+            this->startReply(key, *it);
+        }
+    });
+}
+
+void OrnApiWorker::hedge(const QByteArray &key, quint64 serial)
+{
+    auto it = mJobs.find(key);
+    // Hedge only the replies that have not started to arrive
+    if (it == mJobs.end() || it->serial != serial || !it->reply ||
+        it->hedge || it->timing.firstByte > 0.0)
+    {
+        return;
+    }
+    qDebug() << "Hedging the slow request for" << it->timing.url;
+    it->hedge = this->createReply(key, it->request);
+    it->timing.hedged = true;
+}
+
+bool OrnApiWorker::claimReply(Job &job, QNetworkReply *reply)
+{
+    if (reply == job.hedge)
+    {
+        // The duplicate has answered first
+        dropReply(job.reply);
+        job.reply = job.hedge;
+        job.hedge = nullptr;
+        return true;
+    }
+    if (reply != job.reply)
+    {
+        return false;
+    }
+    dropReply(job.hedge);
+    job.hedge = nullptr;
+    return true;
+}
+
+int OrnApiWorker::hedgeDelay(const QString &url) const
+{
+    auto samples = mFirstByteSamples.value(OrnApiStats::endpoint(url));
+    if (samples.size() < HEDGE_MIN_SAMPLES)
+    {
+        return 0;
+    }
+    auto p95 = samples.begin() + (samples.size() * 95 + 99) / 100 - 1;
+    std::nth_element(samples.begin(), p95, samples.end());
+    return qMax(int(*p95), HEDGE_MIN_DELAY);
+}
+
+void OrnApiWorker::addFirstByteSample(const QString &url, qreal msecs)
+{
+    auto &samples = mFirstByteSamples[OrnApiStats::endpoint(url)];
+    if (samples.size() == HEDGE_MAX_SAMPLES)
+    {
+        samples.removeFirst();
+    }
+    samples << msecs;
+}
+
+bool OrnApiWorker::isBreakerOpen(const QString &host) const
+{
+    auto it = mBreakers.find(host);
+    return it != mBreakers.end() && it->failures >= BREAKER_THRESHOLD &&
+            it->opened.isValid() && it->opened.elapsed() < BREAKER_COOLDOWN;
+}
+
+void OrnApiWorker::addFailure(const QString &host)
+{
+    auto &breaker = mBreakers[host];
+    if (++breaker.failures >= BREAKER_THRESHOLD)
+    {
+        // Also reopens after a failed request in the half-open state
+        qWarning() << host << "is unavailable, serving cached replies for"
+                   << BREAKER_COOLDOWN / 1000 << "seconds";
+        breaker.opened.start();
+    }
+}
+
+QObjectList OrnApiWorker::decode(OrnItemDecoder decoder, const QByteArrayList &json) const
+{
+    QObjectList items;
+    for (const auto &item : json)
+    {
+        OrnJsonReader reader(item);
+        auto object = decoder(reader);
+        object->moveToThread(mTargetThread);
+        items << object;
+    }
+    return items;
+}
+
+void OrnApiWorker::onReplyEncrypted()
+{
+    auto reply = static_cast<QNetworkReply *>(this->sender());
+    auto it = mJobs.find(reply->property(REQUEST_PROPERTY_KEY).toByteArray());
+    if (it != mJobs.end() && it->timing.connect == 0.0)
+    {
+        it->timing.connect = msecs(it->attemptTimer);
+    }
+}
+
+void OrnApiWorker::onReplyMetaDataChanged()
+{
+    auto reply = static_cast<QNetworkReply *>(this->sender());
+    auto it = mJobs.find(reply->property(REQUEST_PROPERTY_KEY).toByteArray());
+    if (it == mJobs.end() || !this->claimReply(*it, reply))
+    {
+        return;
+    }
+    // Only the first headers count, the next ones come after redirects
+    if (it->timing.firstByte == 0.0)
+    {
+        it->timing.firstByte = msecs(it->timer);
+        if (!reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+        {
+            this->addFirstByteSample(it->timing.url, msecs(it->attemptTimer));
+        }
+    }
+}
+
+void OrnApiWorker::onReplyReadyRead()
+{
+    auto reply = static_cast<QNetworkReply *>(this->sender());
+    auto key = reply->property(REQUEST_PROPERTY_KEY).toByteArray();
+    auto it = mJobs.find(key);
+    if (it == mJobs.end() || !this->claimReply(*it, reply))
+    {
+        return;
+    }
+
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+    auto data = reply->readAll();
+    it->items.append(it->reader.read(data));
+    it->body.append(data);
+    if (!it->reader.isArray())
+    {
+        it->timing.decode += msecs(decodeTimer);
+        return;
+    }
+
+    // Hold back the last element until the reply finishes, so the last
+    // rows are inserted when the receiver can already request the next page
+    int available = it->items.size() - 1;
+    for (auto sit = it->streams.begin(); sit != it->streams.end(); ++sit)
+    {
+        auto &stream = sit.value();
+        if (stream.delivered >= available)
+        {
+            continue;
+        }
+        auto json = it->items.mid(stream.delivered, available - stream.delivered);
+        stream.delivered = available;
+        emit this->itemsReady(key, sit.key(), this->decode(stream.decoder, json), json);
+    }
+    it->timing.decode += msecs(decodeTimer);
+}
+
+void OrnApiWorker::onReplyFinished()
+{
+    auto reply = static_cast<QNetworkReply *>(this->sender());
+    reply->deleteLater();
+    auto key = reply->property(REQUEST_PROPERTY_KEY).toByteArray();
+    auto it = mJobs.find(key);
+    if (it == mJobs.end() || (reply != it->reply && reply != it->hedge))
+    {
+        return;
+    }
+
+    auto error = reply->error();
+    if (error != QNetworkReply::NoError && it->hedge)
+    {
+        // Wait for the other one of the racing replies
+        if (reply == it->reply)
+        {
+            it->reply = it->hedge;
+        }
+        it->hedge = nullptr;
+        return;
+    }
+    this->claimReply(*it, reply);
+
+    auto host = it->request.url().host();
+    if (error != QNetworkReply::NoError)
+    {
+        qDebug() << "Network request error" << error << "-" << reply->errorString();
+        if (isTransient(error) && !it->cacheOnly)
+        {
+            this->addFailure(host);
+            if (it->attempt < it->maxRetries && !this->isBreakerOpen(host))
+            {
+                this->retry(key, *it);
+                return;
+            }
+            // Serve the stale copy if there is one
+            qDebug() << "Loading" << it->timing.url << "from cache";
+            it->cacheOnly = true;
+            it->reader = OrnJsonArrayReader();
+            it->items.clear();
+            it->body.clear();
+            it->timing.firstByte = 0.0;
+            this->startReply(key, *it);
+            return;
+        }
+    }
+    else if (!it->cacheOnly)
+    {
+        // The host is reachable again
+        mBreakers.remove(host);
+    }
+
+    auto job = mJobs.take(key);
+    auto &timing = job.timing;
+    timing.transfer = msecs(job.timer) - timing.firstByte;
+    timing.fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    timing.retries = job.attempt;
+
+    if (error != QNetworkReply::NoError)
+    {
+        emit this->replyFinished(key, false, QByteArray(), OrnApiBatchHash(), timing);
+        return;
+    }
+
+    if (timing.fromCache)
+    {
+        qDebug() << "Reply for" << reply->url().toString() << "was loaded from cache";
+    }
+    else
+    {
+        this->saveSessionTicket(reply->sslConfiguration());
+    }
+
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+    auto data = reply->readAll();
+    job.items.append(job.reader.read(data));
+    job.body.append(data);
+    timing.bytes = job.body.size();
+
+    OrnApiBatchHash batches;
+    auto state = job.reader.state();
+    if (state == OrnJsonArrayReader::EndState)
+    {
+        for (auto it = job.streams.cbegin(); it != job.streams.cend(); ++it)
+        {
+            const auto &stream = it.value();
+            auto json = job.items.mid(stream.delivered);
+            batches.insert(it.key(), { this->decode(stream.decoder, json), json });
+        }
+    }
+    else if (state != OrnJsonArrayReader::NotArrayState)
+    {
+        qCritical() << "Could not parse reply:" << job.reader.errorString();
+        emit this->replyFinished(key, false, QByteArray(), OrnApiBatchHash(), timing);
+        return;
+    }
+    timing.decode += msecs(decodeTimer);
+    timing.ok = true;
+    emit this->replyFinished(key, true, job.body, batches, timing);
+}
@@ -0,0 +1,137 @@
+#ifndef ORNAPIWORKER_H
+#define ORNAPIWORKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QByteArrayList>
+#include <QNetworkRequest>
+#include <QSslConfiguration>
+#include <QElapsedTimer>
+
+#include "ornapirequest.h"
+#include "ornapistats.h"
+#include "ornjsonarrayreader.h"
+
+class QThread;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/// The items decoded for a streaming receiver
+struct OrnApiBatch
+{
+    QObjectList items;
+    QByteArrayList json;
+};
+
+/// <receiver, the last batch>
+typedef QHash<quintptr, OrnApiBatch> OrnApiBatchHash;
+
+Q_DECLARE_METATYPE(OrnApiBatch)
+
+/**
+ * @brief The network side of OrnApiDispatcher
+ * Lives in the network thread with its own network access manager and
+ * the API cache. Replies are read and decoded here, the decoded items
+ * are moved to the target thread and sent to the dispatcher in batches.
+ * Receivers are passed as opaque ids and never dereferenced here.
+ */
+class OrnApiWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// The number of retries of a request after transient errors
+    static const QNetworkRequest::Attribute RetriesAttribute = QNetworkRequest::User;
+
+    explicit OrnApiWorker(QThread *targetThread, QObject *parent = nullptr);
+
+public slots:
+    /// Open the connection to the API host ahead of the first request
+    void warmUp();
+    void get(const QByteArray &key, const QNetworkRequest &request);
+    void abort(const QByteArray &key);
+    void addStream(const QByteArray &key, quintptr receiver, OrnItemDecoder decoder);
+    void removeStream(const QByteArray &key, quintptr receiver);
+
+signals:
+    void itemsReady(const QByteArray &key, quintptr receiver,
+                    const QObjectList &items, const QByteArrayList &json);
+    /// The body is empty on errors, the batches are empty for non-array replies
+    void replyFinished(const QByteArray &key, bool ok, const QByteArray &body,
+                       const OrnApiBatchHash &batches, const OrnApiTiming &timing);
+
+private slots:
+    void onReplyEncrypted();
+    void onReplyMetaDataChanged();
+    void onReplyReadyRead();
+    void onReplyFinished();
+
+private:
+    struct Stream
+    {
+        OrnItemDecoder decoder;
+        // The number of delivered elements
+        int delivered;
+    };
+
+    struct Job
+    {
+        Job() : reply(nullptr), hedge(nullptr), attempt(0), maxRetries(0), cacheOnly(false), serial(0) {}
+
+        QNetworkRequest request;
+        QNetworkReply *reply;
+        // The duplicate of a slow reply, the first one to answer wins
+        QNetworkReply *hedge;
+        int attempt;
+        int maxRetries;
+        // Load only from the cache when the API is unavailable
+        bool cacheOnly;
+        // Identifies the current attempt for the delayed calls
+        quint64 serial;
+        OrnJsonArrayReader reader;
+        // The raw elements of an array reply read so far
+        QByteArrayList items;
+        QByteArray body;
+        QHash<quintptr, Stream> streams;
+        QElapsedTimer timer;
+        QElapsedTimer attemptTimer;
+        OrnApiTiming timing;
+    };
+
+    /// Counts the consecutive transient failures of a host
+    struct Breaker
+    {
+        Breaker() : failures(0) {}
+
+        int failures;
+        QElapsedTimer opened;
+    };
+
+    QNetworkAccessManager *manager();
+    QNetworkReply *createReply(const QByteArray &key, const QNetworkRequest &request);
+    void startReply(const QByteArray &key, Job &job);
+    void retry(const QByteArray &key, Job &job);
+    void hedge(const QByteArray &key, quint64 serial);
+    bool claimReply(Job &job, QNetworkReply *reply);
+    int hedgeDelay(const QString &url) const;
+    void addFirstByteSample(const QString &url, qreal msecs);
+    bool isBreakerOpen(const QString &host) const;
+    void addFailure(const QString &host);
+    QObjectList decode(OrnItemDecoder decoder, const QByteArrayList &json) const;
+    void loadSessionTicket();
+    void saveSessionTicket(const QSslConfiguration &configuration);
+
+    QThread *mTargetThread;
+    QNetworkAccessManager *mManager;
+    // Resumes the TLS session of the previous run
+    QSslConfiguration mSslConfiguration;
+    QHash<QByteArray, Job> mJobs;
+    quint64 mSerial;
+    // <host, breaker>
+    QHash<QString, Breaker> mBreakers;
+    // <endpoint, recent times to the first byte>
+    QHash<QString, QVector<qreal>> mFirstByteSamples;
+};
+
+#endif // ORNAPIWORKER_H
@@ -0,0 +1,100 @@
+#include "ornappdetails.h"
+#include "orncategorylistitem.h"
+#include "ornjsonreader.h"
+
+OrnAppDetails::OrnAppDetails()
+    : userId(0)
+    , ratingCount(0)
+    , commentsCount(0)
+    , downloadsCount(0)
+    , rating(0.0)
+{
+
+}
+
+OrnAppDetails OrnAppDetails::fromJson(const QByteArray &json)
+{
+    typedef OrnJsonField<OrnAppDetails> Field;
+    static const Field urlFields[] = {
+        { "url", [](OrnJsonReader &r, OrnAppDetails &a) { a.iconSource = r.readString(); } }
+    };
+    static const Field packageFields[] = {
+        { "name", [](OrnJsonReader &r, OrnAppDetails &a) { a.packageName = r.readString(); } }
+    };
+    static const Field pictureFields[] = {
+        { "url", [](OrnJsonReader &r, OrnAppDetails &a) { a.userIconSource = r.readString(); } }
+    };
+    static const Field userFields[] = {
+        { "uid",     [](OrnJsonReader &r, OrnAppDetails &a) { a.userId = r.readUint(); } },
+        { "name",    [](OrnJsonReader &r, OrnAppDetails &a) { a.userName = r.readString(); } },
+        { "picture", [](OrnJsonReader &r, OrnAppDetails &a) { r.decode(a, pictureFields); } }
+    };
+    static const Field ratingFields[] = {
+        { "count",  [](OrnJsonReader &r, OrnAppDetails &a) { a.ratingCount = r.readUint(); } },
+        { "rating", [](OrnJsonReader &r, OrnAppDetails &a) { a.rating = r.readFloat(); } }
+    };
+    static const OrnJsonField<quint32> tidFields[] = {
+        { "tid", [](OrnJsonReader &r, quint32 &tid) { tid = r.readUint(); } }
+    };
+    static const OrnJsonField<QVariantMap> thumbsFields[] = {
+        { "large", [](OrnJsonReader &r, QVariantMap &s) { s.insert(QStringLiteral("thumb"), r.readString()); } }
+    };
+    static const OrnJsonField<QVariantMap> screenshotFields[] = {
+        { "url",    [](OrnJsonReader &r, QVariantMap &s) { s.insert(QStringLiteral("url"), r.readString()); } },
+        { "thumbs", [](OrnJsonReader &r, QVariantMap &s) { r.decode(s, thumbsFields); } }
+    };
+    static const Field fields[] = {
+        { "comments_count", [](OrnJsonReader &r, OrnAppDetails &a) { a.commentsCount = r.readUint(); } },
+        { "downloads", [](OrnJsonReader &r, OrnAppDetails &a) { a.downloadsCount = r.readUint(); } },
+        { "title",     [](OrnJsonReader &r, OrnAppDetails &a) { a.title = r.readString(); } },
+        { "icon",      [](OrnJsonReader &r, OrnAppDetails &a) { r.decode(a, urlFields); } },
+        { "package",   [](OrnJsonReader &r, OrnAppDetails &a) { r.decode(a, packageFields); } },
+        { "body",      [](OrnJsonReader &r, OrnAppDetails &a) { a.body = r.readString(); } },
+        { "changelog", [](OrnJsonReader &r, OrnAppDetails &a) { a.changelog = r.readString(); } },
+        { "created",   [](OrnJsonReader &r, OrnAppDetails &a)
+            { a.created = QDateTime::fromMSecsSinceEpoch(quint64(r.readUint()) * 1000); } },
+        { "updated",   [](OrnJsonReader &r, OrnAppDetails &a)
+            { a.updated = QDateTime::fromMSecsSinceEpoch(quint64(r.readUint()) * 1000); } },
+        { "user",      [](OrnJsonReader &r, OrnAppDetails &a) { r.decode(a, userFields); } },
+        { "rating",    [](OrnJsonReader &r, OrnAppDetails &a) { r.decode(a, ratingFields); } },
+        { "category",  [](OrnJsonReader &r, OrnAppDetails &a)
+            {
+                if (!r.beginArray())
+                {
+                    return;
+                }
+                while (r.nextElement())
+                {
+                    quint32 tid = 0;
+                    r.decode(tid, tidFields);
+                    a.categories << QVariantMap{
+                        { "id",   tid },
+                        { "name", OrnCategoryListItem::categoryName(tid) }
+                    };
+                }
+            }
+        },
+        { "screenshots", [](OrnJsonReader &r, OrnAppDetails &a)
+            {
+                if (!r.beginArray())
+                {
+                    return;
+                }
+                while (r.nextElement())
+                {
+                    QVariantMap screenshot{
+                        { "url",   QString() },
+                        { "thumb", QString() }
+                    };
+                    r.decode(screenshot, screenshotFields);
+                    a.screenshots << screenshot;
+                }
+            }
+        }
+    };
+
+    OrnAppDetails details;
+    OrnJsonReader reader(json);
+    reader.decode(details, fields);
+    return details;
+}
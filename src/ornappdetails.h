@@ -0,0 +1,39 @@
+#ifndef ORNAPPDETAILS_H
+#define ORNAPPDETAILS_H
+
+#include <QDateTime>
+#include <QVariantList>
+
+/**
+ * @brief The app details from the apps/<id> API reply
+ * Decoded apart from OrnApplication, so the decoding can be used
+ * without the package manager and the network stack.
+ */
+struct OrnAppDetails
+{
+    OrnAppDetails();
+
+    /// Decode the reply, the missing keys keep the default values
+    static OrnAppDetails fromJson(const QByteArray &json);
+
+    quint32 userId;
+    quint32 ratingCount;
+    quint32 commentsCount;
+    quint32 downloadsCount;
+    float rating;
+    QString title;
+    QString userName;
+    QString userIconSource;
+    QString iconSource;
+    QString packageName;
+    QString body;
+    QString changelog;
+    QDateTime created;
+    QDateTime updated;
+    /// Maps of the category ids and names
+    QVariantList categories;
+    /// Maps of the screenshot and thumbnail urls
+    QVariantList screenshots;
+};
+
+#endif // ORNAPPDETAILS_H
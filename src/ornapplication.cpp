@@ -1,13 +1,9 @@
 #include "ornapplication.h"
-#include "orn.h"
-#include "orncategorylistitem.h"
+#include "ornappdetails.h"
 
 #include <QUrl>
 #include <QNetworkRequest>
 #include <QDesktopServices>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QFileInfo>
 
 #include <QDebug>
@@ -39,6 +35,7 @@ OrnApplication::OrnApplication(QObject *parent)
     , mRatingCount(0)
     , mCommentsCount(0)
     , mRating(0.0)
+    , mInstallPreview()
 {
     connect(this, &OrnApplication::jsonReady, this, &OrnApplication::onJsonReady);
 
@@ -54,6 +51,7 @@ OrnApplication::OrnApplication(QObject *parent)
     });
 
     connect(ornPm, &OrnPm::packageVersions, this, &OrnApplication::onPackageVersions);
+    connect(ornPm, &OrnPm::installPreview, this, &OrnApplication::onInstallPreview);
 }
 
 quint32 OrnApplication::appId() const
@@ -139,6 +137,26 @@ quint64 OrnApplication::globalVersionInstallSize() const
     return mGlobalVersion.installSize;
 }
 
+QStringList OrnApplication::installSet() const
+{
+    return mInstallPreview.install;
+}
+
+quint64 OrnApplication::installSetDownloadSize() const
+{
+    return mInstallPreview.downloadSize;
+}
+
+quint64 OrnApplication::installSetInstallSize() const
+{
+    return mInstallPreview.installSize;
+}
+
+QStringList OrnApplication::installProblems() const
+{
+    return mInstallPreview.problems;
+}
+
 bool OrnApplication::canBeLaunched() const
 {
     return !mDesktopFile.isEmpty();
@@ -169,55 +187,35 @@ void OrnApplication::launch()
     QDesktopServices::openUrl(QUrl::fromLocalFile(mDesktopFile));
 }
 
-void OrnApplication::onJsonReady(const QJsonDocument &jsonDoc)
+void OrnApplication::previewInstall()
 {
-    auto jsonObject = jsonDoc.object();
-    QString urlKey(QStringLiteral("url"));
-    QString nameKey(QStringLiteral("name"));
-
-    mCommentsCount = Orn::toUint(jsonObject[QStringLiteral("comments_count")]);
-    mDownloadsCount = Orn::toUint(jsonObject[QStringLiteral("downloads")]);
-    mTitle = Orn::toString(jsonObject[QStringLiteral("title")]);
-    mIconSource = Orn::toString(jsonObject[QStringLiteral("icon")].toObject()[urlKey]);
-    mPackageName = Orn::toString(jsonObject[QStringLiteral("package")].toObject()[nameKey]);
-    mBody = Orn::toString(jsonObject[QStringLiteral("body")]);
-    mChangelog = Orn::toString(jsonObject[QStringLiteral("changelog")]);
-    mCreated = Orn::toDateTime(jsonObject[QStringLiteral("created")]);
-    mUpdated = Orn::toDateTime(jsonObject[QStringLiteral("updated")]);
-
-    auto userObject = jsonObject[QStringLiteral("user")].toObject();
-    mUserId = Orn::toUint(userObject[QStringLiteral("uid")]);
-    mUserName = Orn::toString(userObject[nameKey]);
-    mUserIconSource = Orn::toString(userObject[QStringLiteral("picture")].toObject()[urlKey]);
-
-    QString ratingKey(QStringLiteral("rating"));
-    auto ratingObject = jsonObject[ratingKey].toObject();
-    mRatingCount = Orn::toUint(ratingObject[QStringLiteral("count")]);
-    mRating = ratingObject[ratingKey].toString().toFloat();
-
-//    mTagsIds = Orn::toIntList(jsonObject[QStringLiteral("tags")]);
-    auto catIds = Orn::toIntList(jsonObject[QStringLiteral("category")]);
-    mCategories.clear();
-    for (const auto &id : catIds)
+    if (mPackageName.isEmpty() || mAvailableVersion.version.isEmpty())
     {
-        mCategories << QVariantMap{
-            { "id",   id },
-            { "name", OrnCategoryListItem::categoryName(id) }
-        };
+        qWarning() << this << ": no available version to preview the installation";
+        return;
     }
+    OrnPm::instance()->previewInstall(this->availableId());
+}
 
-    QString thumbsKey(QStringLiteral("thumbs"));
-    QString largeKey(QStringLiteral("large"));
-    auto jsonArray = jsonObject[QStringLiteral("screenshots")].toArray();
-    mScreenshots.clear();
-    for (const QJsonValue &v: jsonArray)
-    {
-        auto o = v.toObject();
-        mScreenshots << QVariantMap{
-            { "url",   Orn::toString(o[urlKey]) },
-            { "thumb", Orn::toString(o[thumbsKey].toObject()[largeKey]) }
-        };
-    }
+void OrnApplication::onJsonReady(const QByteArray &json)
+{
+    auto details = OrnAppDetails::fromJson(json);
+    mCommentsCount = details.commentsCount;
+    mDownloadsCount = details.downloadsCount;
+    mUserId = details.userId;
+    mRatingCount = details.ratingCount;
+    mRating = details.rating;
+    mTitle = details.title;
+    mIconSource = details.iconSource;
+    mPackageName = details.packageName;
+    mBody = details.body;
+    mChangelog = details.changelog;
+    mCreated = details.created;
+    mUpdated = details.updated;
+    mUserName = details.userName;
+    mUserIconSource = details.userIconSource;
+    mCategories = details.categories;
+    mScreenshots = details.screenshots;
 
     if (!mUserName.isEmpty())
     {
@@ -357,6 +355,16 @@ void OrnApplication::onPackageVersions(const QString &packageName, const OrnPack
     }
 }
 
+void OrnApplication::onInstallPreview(const OrnInstallPreview &preview)
+{
+    if (mPackageName.isEmpty() || preview.packageId != this->availableId())
+    {
+        return;
+    }
+    mInstallPreview = preview;
+    emit this->installPreviewChanged();
+}
+
 void OrnApplication::updateDesktopFile()
 {
     auto desktopFile = mDesktopFile;
@@ -4,6 +4,7 @@
 #include "ornapirequest.h"
 #include "ornpm.h"
 #include "ornpackageversion.h"
+#include "orninstallpreview.h"
 
 #include <QDateTime>
 
@@ -33,6 +34,10 @@ class OrnApplication : public OrnApiRequest
     Q_PROPERTY(bool globalVersionIsNewer READ globalVersionIsNewer NOTIFY globalVersionIsNewerChanged)
     Q_PROPERTY(quint64 globalVersionDownloadSize READ globalVersionDownloadSize NOTIFY globalVersionChanged)
     Q_PROPERTY(quint64 globalVersionInstallSize READ globalVersionInstallSize NOTIFY globalVersionChanged)
+    Q_PROPERTY(QStringList installSet READ installSet NOTIFY installPreviewChanged)
+    Q_PROPERTY(quint64 installSetDownloadSize READ installSetDownloadSize NOTIFY installPreviewChanged)
+    Q_PROPERTY(quint64 installSetInstallSize READ installSetInstallSize NOTIFY installPreviewChanged)
+    Q_PROPERTY(QStringList installProblems READ installProblems NOTIFY installPreviewChanged)
 
     Q_PROPERTY(quint32 appId READ appId WRITE setAppId NOTIFY appIdChanged)
     Q_PROPERTY(quint32 userId MEMBER mUserId NOTIFY ornRequestFinished)
@@ -75,6 +80,11 @@ public:
     quint64 globalVersionDownloadSize() const;
     quint64 globalVersionInstallSize() const;
 
+    QStringList installSet() const;
+    quint64 installSetDownloadSize() const;
+    quint64 installSetInstallSize() const;
+    QStringList installProblems() const;
+
     bool canBeLaunched() const;
 
     QString category() const;
@@ -90,16 +100,19 @@ signals:
     void availableVersionIsNewerChanged();
     void globalVersionChanged();
     void globalVersionIsNewerChanged();
+    void installPreviewChanged();
 
 public slots:
     void ornRequest();
     void launch();
+    void previewInstall();
 
 private slots:
-    void onJsonReady(const QJsonDocument &jsonDoc);
+    void onJsonReady(const QByteArray &json);
     void onRepoListChanged();
     void onPackageStatusChanged(const QString &packageName, const OrnPm::PackageStatus &status);
     void onPackageVersions(const QString &packageName, const OrnPackageVersionList &versions);
+    void onInstallPreview(const OrnInstallPreview &preview);
 
 private:
     void updateDesktopFile();
@@ -118,6 +131,7 @@ private:
     OrnPackageVersion mInstalledVersion;
     OrnPackageVersion mAvailableVersion;
     OrnPackageVersion mGlobalVersion;
+    OrnInstallPreview mInstallPreview;
 
     QString mRepoAlias;
     QString mDesktopFile;
@@ -1,9 +1,7 @@
 #include "ornapplistitem.h"
-#include "orn.h"
 #include "orncategorylistitem.h"
+#include "ornjsonreader.h"
 
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QDateTime>
 
 #include <QDebug>
@@ -14,24 +12,54 @@ OrnAppListItem::OrnAppListItem(QObject *parent) :
     Q_ASSERT_X(false, Q_FUNC_INFO, "This constructor is only for moc");
 }
 
-OrnAppListItem::OrnAppListItem(const QJsonObject &jsonObject, QObject *parent) :
+OrnAppListItem::OrnAppListItem(OrnJsonReader &reader, QObject *parent) :
     QObject(parent),
-    mAppId(jsonObject[QStringLiteral("appid")].toVariant().toUInt()),
-    mCreated(Orn::toUint(jsonObject[QStringLiteral("created")])),
-    mUpdated(Orn::toUint(jsonObject[QStringLiteral("updated")])),
-    mTitle(Orn::toString(jsonObject[QStringLiteral("title")])),
-    mUserName(Orn::toString(jsonObject[QStringLiteral("user")].toObject()[QStringLiteral("name")])),
-    mIconSource(Orn::toString(jsonObject[QStringLiteral("icon")].toObject()[QStringLiteral("url")])),
-    mSinceUpdate(sinceLabel(mCreated))
+    mAppId(0),
+    mCreated(0),
+    mUpdated(0),
+    mRatingCount(0),
+    mRating(0.0)
 {
-    QString ratingKey(QStringLiteral("rating"));
-    auto ratingObject = jsonObject[ratingKey].toObject();
-    mRatingCount = Orn::toUint(ratingObject[QStringLiteral("count")]);
-    mRating = ratingObject[ratingKey].toString().toFloat();
+    typedef OrnJsonField<OrnAppListItem> Field;
+    static const Field userFields[] = {
+        { "name", [](OrnJsonReader &r, OrnAppListItem &i) { i.mUserName = r.readString(); } }
+    };
+    static const Field iconFields[] = {
+        { "url", [](OrnJsonReader &r, OrnAppListItem &i) { i.mIconSource = r.readString(); } }
+    };
+    static const Field ratingFields[] = {
+        { "count",  [](OrnJsonReader &r, OrnAppListItem &i) { i.mRatingCount = r.readUint(); } },
+        { "rating", [](OrnJsonReader &r, OrnAppListItem &i) { i.mRating = r.readFloat(); } }
+    };
+    static const OrnJsonField<quint32> tidFields[] = {
+        { "tid", [](OrnJsonReader &r, quint32 &tid) { tid = r.readUint(); } }
+    };
+    static const Field fields[] = {
+        { "appid",   [](OrnJsonReader &r, OrnAppListItem &i) { i.mAppId = r.readUint(); } },
+        { "created", [](OrnJsonReader &r, OrnAppListItem &i) { i.mCreated = r.readUint(); } },
+        { "updated", [](OrnJsonReader &r, OrnAppListItem &i) { i.mUpdated = r.readUint(); } },
+        { "title",   [](OrnJsonReader &r, OrnAppListItem &i) { i.mTitle = r.readString(); } },
+        { "user",    [](OrnJsonReader &r, OrnAppListItem &i) { r.decode(i, userFields); } },
+        { "icon",    [](OrnJsonReader &r, OrnAppListItem &i) { r.decode(i, iconFields); } },
+        { "rating",  [](OrnJsonReader &r, OrnAppListItem &i) { r.decode(i, ratingFields); } },
+        { "category", [](OrnJsonReader &r, OrnAppListItem &i)
+            {
+                // Use the last category
+                quint32 tid = 0;
+                if (r.beginArray())
+                {
+                    while (r.nextElement())
+                    {
+                        r.decode(tid, tidFields);
+                    }
+                }
+                i.mCategory = OrnCategoryListItem::categoryName(tid);
+            }
+        }
+    };
 
-    auto categories = jsonObject[QStringLiteral("category")].toArray();
-    auto tid = Orn::toUint(categories.last().toObject()[QStringLiteral("tid")]);
-    mCategory = OrnCategoryListItem::categoryName(tid);
+    reader.decode(*this, fields);
+    mSinceUpdate = sinceLabel(mCreated);
 }
 
 QString OrnAppListItem::sinceLabel(const quint32 &value)
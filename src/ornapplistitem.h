@@ -3,6 +3,8 @@
 
 #include <QObject>
 
+class OrnJsonReader;
+
 // TODO: add "installed" property
 class OrnAppListItem : public QObject
 {
@@ -22,7 +24,7 @@ class OrnAppListItem : public QObject
 
 public:
     explicit OrnAppListItem(QObject *parent = nullptr);
-    OrnAppListItem(const QJsonObject &jsonObject, QObject *parent = nullptr);
+    OrnAppListItem(OrnJsonReader &reader, QObject *parent = nullptr);
 
 private:
     static QString sinceLabel(const quint32 &value);
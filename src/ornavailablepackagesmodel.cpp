@@ -0,0 +1,270 @@
+#include "ornavailablepackagesmodel.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+OrnAvailablePackagesModel::OrnAvailablePackagesModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , mRefreshing(false)
+    , mRefreshPending(false)
+    , mFilter(AllPackages)
+{
+    auto ornPm = OrnPm::instance();
+    connect(ornPm, &OrnPm::availablePackages,
+            this, &OrnAvailablePackagesModel::onAvailablePackages);
+    connect(ornPm, &OrnPm::packageStatusChanged,
+            this, &OrnAvailablePackagesModel::onPackageStatusChanged);
+    connect(ornPm, &OrnPm::repoModified, this, &OrnAvailablePackagesModel::refresh);
+    connect(ornPm, &OrnPm::reposRefreshed, this, &OrnAvailablePackagesModel::refresh);
+    connect(ornPm, &OrnPm::enableReposFinished, this, &OrnAvailablePackagesModel::refresh);
+
+    if (ornPm->initialised())
+    {
+        this->refresh();
+    }
+    else
+    {
+        connect(ornPm, &OrnPm::initialisedChanged, this, &OrnAvailablePackagesModel::refresh);
+    }
+}
+
+OrnAvailablePackagesModel::Filter OrnAvailablePackagesModel::filter() const
+{
+    return mFilter;
+}
+
+void OrnAvailablePackagesModel::setFilter(const Filter &filter)
+{
+    if (mFilter != filter)
+    {
+        mFilter = filter;
+        emit this->filterChanged();
+        this->applyFilter();
+    }
+}
+
+QString OrnAvailablePackagesModel::repoAlias() const
+{
+    return mRepoAlias;
+}
+
+void OrnAvailablePackagesModel::setRepoAlias(const QString &repoAlias)
+{
+    if (mRepoAlias != repoAlias)
+    {
+        mRepoAlias = repoAlias;
+        emit this->repoAliasChanged();
+        this->applyFilter();
+    }
+}
+
+void OrnAvailablePackagesModel::refresh()
+{
+    // The running request could have read the old repos,
+    // so repeat it once it finishes
+    if (mRefreshing)
+    {
+        mRefreshPending = true;
+        return;
+    }
+    mRefreshing = true;
+    OrnPm::instance()->getAvailablePackages();
+}
+
+void OrnAvailablePackagesModel::onAvailablePackages(const OrnPackageVersionMap &packages)
+{
+    mPackages = packages;
+    this->applyFilter();
+    if (mRefreshPending)
+    {
+        mRefreshPending = false;
+        OrnPm::instance()->getAvailablePackages();
+        return;
+    }
+    mRefreshing = false;
+}
+
+void OrnAvailablePackagesModel::onPackageStatusChanged(const QString &packageName,
+                                                       const OrnPm::PackageStatus &status)
+{
+    Q_UNUSED(status)
+    if (!mPackages.contains(packageName))
+    {
+        return;
+    }
+
+    if (mFilter != AllPackages)
+    {
+        // The package could be filtered in or out
+        this->applyFilter();
+        return;
+    }
+
+    auto row = this->findRow(packageName);
+    if (row != -1)
+    {
+        auto ind = this->createIndex(row, 0);
+        emit this->dataChanged(ind, ind, { StatusRole });
+    }
+}
+
+bool OrnAvailablePackagesModel::accepts(const QString &name) const
+{
+    if (mFilter == AllPackages)
+    {
+        return true;
+    }
+
+    auto status = OrnPm::instance()->packageStatus(name);
+    switch (mFilter)
+    {
+    case InstalledPackages:
+        return status >= OrnPm::PackageInstalled && status != OrnPm::PackageInstalling;
+    case UpdatablePackages:
+        return status == OrnPm::PackageUpdateAvailable || status == OrnPm::PackageUpdating;
+    case NotInstalledPackages:
+        return status == OrnPm::PackageNotInstalled || status == OrnPm::PackageInstalling;
+    default:
+        return true;
+    }
+}
+
+int OrnAvailablePackagesModel::findRow(const QString &packageName) const
+{
+    // Rows are sorted by name
+    auto it = std::lower_bound(mData.cbegin(), mData.cend(), packageName,
+                               [](const Package &package, const QString &name)
+    {
+        return package.name < name;
+    });
+    return it != mData.cend() && it->name == packageName ? int(it - mData.cbegin()) : -1;
+}
+
+void OrnAvailablePackagesModel::applyFilter()
+{
+    // Prepare the new rows
+    PackageVector rows;
+    rows.reserve(mPackages.size());
+    auto filterRepo = !mRepoAlias.isEmpty();
+    for (auto it = mPackages.cbegin(); it != mPackages.cend(); ++it)
+    {
+        const auto &name = it.key();
+        if (!this->accepts(name))
+        {
+            continue;
+        }
+        // Versions are sorted from the newest one
+        for (const auto &version : it.value())
+        {
+            if (!filterRepo || version.repoAlias == mRepoAlias)
+            {
+                rows.append(Package{ name, version });
+                break;
+            }
+        }
+    }
+
+    // Merge the sorted rows into the model with the minimal changes
+    QModelIndex parentIndex;
+    int i = 0;
+    int j = 0;
+    auto newSize = rows.size();
+    // The rows are inserted and removed in place without reallocations
+    mData.reserve(qMax(mData.size(), newSize));
+    while (i < mData.size() || j < newSize)
+    {
+        if (j == newSize || (i < mData.size() && mData[i].name < rows[j].name))
+        {
+            // Remove the range of the rows absent in the new data
+            auto last = i;
+            while (last + 1 < mData.size() &&
+                   (j == newSize || mData[last + 1].name < rows[j].name))
+            {
+                ++last;
+            }
+            this->beginRemoveRows(parentIndex, i, last);
+            mData.remove(i, last - i + 1);
+            this->endRemoveRows();
+        }
+        else if (i == mData.size() || rows[j].name < mData[i].name)
+        {
+            // Insert the range of the new rows
+            auto last = j;
+            while (last + 1 < newSize &&
+                   (i == mData.size() || rows[last + 1].name < mData[i].name))
+            {
+                ++last;
+            }
+            auto count = last - j + 1;
+            this->beginInsertRows(parentIndex, i, i + count - 1);
+            mData.insert(i, count, Package());
+            std::copy(rows.cbegin() + j, rows.cbegin() + j + count, mData.begin() + i);
+            this->endInsertRows();
+            i += count;
+            j += count;
+        }
+        else
+        {
+            if (mData[i].version != rows[j].version)
+            {
+                mData[i].version = rows[j].version;
+                auto ind = this->createIndex(i, 0);
+                emit this->dataChanged(ind, ind);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    qDebug() << "Model has" << mData.size() << "available packages";
+}
+
+int OrnAvailablePackagesModel::rowCount(const QModelIndex &parent) const
+{
+    return !parent.isValid() ? mData.size() : 0;
+}
+
+QVariant OrnAvailablePackagesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+    {
+        return QVariant();
+    }
+
+    const auto &package = mData[index.row()];
+    switch (role)
+    {
+    case NameRole:
+        return package.name;
+    case VersionRole:
+        return package.version.version;
+    case ArchRole:
+        return package.version.arch;
+    case RepoAliasRole:
+        return package.version.repoAlias;
+    case DownloadSizeRole:
+        return package.version.downloadSize;
+    case InstallSizeRole:
+        return package.version.installSize;
+    case StatusRole:
+        return OrnPm::instance()->packageStatus(package.name);
+    case SectionRole:
+        return package.name.at(0).toUpper();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> OrnAvailablePackagesModel::roleNames() const
+{
+    return {
+        { NameRole,         "packageName"         },
+        { VersionRole,      "packageVersion"      },
+        { ArchRole,         "packageArch"         },
+        { RepoAliasRole,    "repoAlias"           },
+        { DownloadSizeRole, "packageDownloadSize" },
+        { InstallSizeRole,  "packageInstallSize"  },
+        { StatusRole,       "packageStatus"       },
+        { SectionRole,      "section"             }
+    };
+}
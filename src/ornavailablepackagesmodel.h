@@ -0,0 +1,84 @@
+#ifndef ORNAVAILABLEPACKAGESMODEL_H
+#define ORNAVAILABLEPACKAGESMODEL_H
+
+#include <QAbstractListModel>
+
+#include "ornpm.h"
+
+class OrnAvailablePackagesModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(Filter filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString repoAlias READ repoAlias WRITE setRepoAlias NOTIFY repoAliasChanged)
+
+public:
+
+    enum Filter
+    {
+        AllPackages,
+        InstalledPackages,
+        UpdatablePackages,
+        NotInstalledPackages
+    };
+    Q_ENUM(Filter)
+
+    enum Roles
+    {
+        NameRole = Qt::UserRole + 1,
+        VersionRole,
+        ArchRole,
+        RepoAliasRole,
+        DownloadSizeRole,
+        InstallSizeRole,
+        StatusRole,
+        SectionRole
+    };
+    Q_ENUM(Roles)
+
+    explicit OrnAvailablePackagesModel(QObject *parent = nullptr);
+
+    Filter filter() const;
+    void setFilter(const Filter &filter);
+
+    QString repoAlias() const;
+    void setRepoAlias(const QString &repoAlias);
+
+public slots:
+    void refresh();
+
+signals:
+    void filterChanged();
+    void repoAliasChanged();
+
+private slots:
+    void onAvailablePackages(const OrnPackageVersionMap &packages);
+    void onPackageStatusChanged(const QString &packageName, const OrnPm::PackageStatus &status);
+
+private:
+    struct Package
+    {
+        QString name;
+        OrnPackageVersion version;
+    };
+    typedef QVector<Package> PackageVector;
+
+    bool accepts(const QString &name) const;
+    int findRow(const QString &packageName) const;
+    void applyFilter();
+
+    bool mRefreshing;
+    // A refresh was requested while the previous one was running
+    bool mRefreshPending;
+    Filter mFilter;
+    QString mRepoAlias;
+    OrnPackageVersionMap mPackages;
+    PackageVector mData;
+
+    // QAbstractItemModel interface
+public:
+    int rowCount(const QModelIndex &parent) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+};
+
+#endif // ORNAVAILABLEPACKAGESMODEL_H
@@ -1,29 +1,87 @@
 #include "ornbackup.h"
-#include "ornzypp.h"
-#include "ornversion.h"
+#include "ornpm_p.h"
 #include "ornclient.h"
+#include "orn.h"
 
 #include <QFileInfo>
+#include <QDir>
 #include <QSettings>
+#include <QTimer>
+#include <QDataStream>
+#include <QCryptographicHash>
 #include <QtConcurrent/QtConcurrent>
 #include <QFutureWatcher>
-#include <QtDBus/QDBusMessage>
-#include <QtDBus/QDBusConnection>
 
 #include <QDebug>
 
+#include <limits>
+
+// Keys of the legacy INI backups
 #define BR_CREATED       QStringLiteral("created")
 #define BR_REPO_ALL      QStringLiteral("repos/all")
 #define BR_REPO_DISABLED QStringLiteral("repos/disabled")
 #define BR_INSTALLED     QStringLiteral("packages/installed")
 #define BR_BOOKMARKS     QStringLiteral("packages/bookmarks")
 
-OrnBackup::OrnBackup(QObject *parent) :
-    QObject(parent),
-    mZypp(OrnZypp::instance()),
-    mStatus(Idle)
+// The binary backup format:
+// magic, version, sections count, index of [ id, offset, size ] and the sections.
+// The meta section is not compressed so the details could be read without
+// touching the rest of the file.
+#define BR_MAGIC          quint32(0x4f524e42) // ORNB
+#define BR_VERSION        quint16(1)
+#define BR_STREAM_VERSION QDataStream::Qt_5_0
+
+#define BR_SECTION_META      quint16(0)
+#define BR_SECTION_REPOS     quint16(1)
+#define BR_SECTION_PACKAGES  quint16(2)
+#define BR_SECTION_BOOKMARKS quint16(3)
+
+#define BR_AUTO_DIR      QStringLiteral("backup/dir")
+#define BR_AUTO_INTERVAL QStringLiteral("backup/interval")
+#define BR_AUTO_HASH     QStringLiteral("backup/hash")
+#define BR_AUTO_FILE     QStringLiteral("backup/file")
+#define BR_AUTO_TIME     QStringLiteral("backup/time")
+// The number of the newest scheduled backups to keep
+#define BR_AUTO_KEEP     10
+#define BR_AUTO_PATTERN  QStringLiteral("????????-??????.ornbackup")
+
+struct OrnBackup::Snapshot
 {
+    QDateTime created;
+    QStringList repos;
+    QStringList disabled;
+    QStringList installed;
+    QList<quint32> bookmarks;
 
+    QByteArray hash() const
+    {
+        // Sort everything to make the hash independent of the hash tables order
+        auto r = repos;
+        auto d = disabled;
+        auto i = installed;
+        auto b = bookmarks;
+        r.sort();
+        d.sort();
+        i.sort();
+        std::sort(b.begin(), b.end());
+
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(BR_STREAM_VERSION);
+        stream << r << d << i << b;
+        return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    }
+};
+
+OrnBackup::OrnBackup(QObject *parent)
+    : QObject(parent)
+    , mStatus(Idle)
+    , mPendingRepoCalls(0)
+    , mAutoBackupTimer(new QTimer(this))
+{
+    mAutoBackupTimer->setSingleShot(true);
+    connect(mAutoBackupTimer, &QTimer::timeout, this, &OrnBackup::pAutoBackup);
+    this->setAutoBackupTimer();
 }
 
 OrnBackup::Status OrnBackup::status() const
@@ -40,17 +98,143 @@ void OrnBackup::setStatus(const Status &status)
     }
 }
 
+QString OrnBackup::autoBackupDir() const
+{
+    return QSettings().value(BR_AUTO_DIR).toString();
+}
+
+void OrnBackup::setAutoBackupDir(const QString &dirPath)
+{
+    QSettings settings;
+    if (settings.value(BR_AUTO_DIR).toString() != dirPath)
+    {
+        settings.setValue(BR_AUTO_DIR, dirPath);
+        emit this->autoBackupChanged();
+        this->setAutoBackupTimer();
+    }
+}
+
+int OrnBackup::autoBackupInterval() const
+{
+    return QSettings().value(BR_AUTO_INTERVAL, 0).toInt();
+}
+
+void OrnBackup::setAutoBackupInterval(int hours)
+{
+    QSettings settings;
+    if (settings.value(BR_AUTO_INTERVAL, 0).toInt() != hours)
+    {
+        settings.setValue(BR_AUTO_INTERVAL, hours);
+        emit this->autoBackupChanged();
+        this->setAutoBackupTimer();
+    }
+}
+
+void OrnBackup::setAutoBackupTimer()
+{
+    mAutoBackupTimer->stop();
+
+    QSettings settings;
+    auto hours = settings.value(BR_AUTO_INTERVAL, 0).toInt();
+    if (hours <= 0 || settings.value(BR_AUTO_DIR).toString().isEmpty())
+    {
+        return;
+    }
+
+    // Wait at least a minute to let OrnPm initialise
+    qint64 interval = qint64(hours) * 3600000;
+    auto last = settings.value(BR_AUTO_TIME).toDateTime();
+    auto delay = last.isValid() ?
+                interval - last.msecsTo(QDateTime::currentDateTimeUtc()) : 0;
+    delay = qBound(qint64(60000), delay, qint64(std::numeric_limits<int>::max()));
+    qDebug() << "Next scheduled backup in" << delay / 60000 << "minutes";
+    mAutoBackupTimer->start(int(delay));
+}
+
+void OrnBackup::pAutoBackup()
+{
+    if (mStatus != Idle || !OrnPm::instance()->initialised())
+    {
+        qDebug() << "Postponing the scheduled backup";
+        mAutoBackupTimer->start(60000);
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue(BR_AUTO_TIME, QDateTime::currentDateTimeUtc());
+    this->setAutoBackupTimer();
+
+    QDir dir(settings.value(BR_AUTO_DIR).toString());
+    if (!dir.exists() && !dir.mkpath(QChar('.')))
+    {
+        qCritical() << "Failed to create directory" << dir.absolutePath();
+        emit this->backupError(DirectoryError);
+        return;
+    }
+    auto filePath = dir.absoluteFilePath(
+                QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-hhmmss")) +
+                QStringLiteral(".ornbackup"));
+    QtConcurrent::run(this, &OrnBackup::pBackupIfChanged, filePath);
+}
+
 QVariantMap OrnBackup::details(const QString &path)
 {
     Q_ASSERT_X(QFileInfo(path).isFile(), Q_FUNC_INFO, "Backup file does not exist");
 
     QVariantMap res;
+
+    QFile bfile(path);
+    if (!bfile.open(QFile::ReadOnly))
+    {
+        qWarning() << "Could not read backup file" << path;
+        return res;
+    }
+
+    QDataStream stream(&bfile);
+    stream.setVersion(BR_STREAM_VERSION);
+    quint32 magic;
+    quint16 version;
+    quint16 count;
+    stream >> magic >> version >> count;
+    if (magic == BR_MAGIC)
+    {
+        if (version > BR_VERSION)
+        {
+            qWarning() << "Unsupported backup version" << version;
+            return res;
+        }
+        // Seek directly to the meta section
+        for (quint16 i = 0; i < count; ++i)
+        {
+            quint16 id;
+            quint32 offset;
+            quint32 size;
+            stream >> id >> offset >> size;
+            if (id == BR_SECTION_META)
+            {
+                bfile.seek(offset);
+                QDateTime created;
+                QByteArray hash;
+                quint32 repos, packages, bookmarks;
+                stream >> created >> hash >> repos >> packages >> bookmarks;
+                res.insert(QLatin1String("created"),   created.toLocalTime());
+                res.insert(QLatin1String("repos"),     repos);
+                res.insert(QLatin1String("packages"),  packages);
+                res.insert(QLatin1String("bookmarks"), bookmarks);
+                break;
+            }
+        }
+        return res;
+    }
+    bfile.close();
+
+    // Fallback to the legacy format
     QSettings file(path, QSettings::IniFormat);
 
     res.insert(QLatin1String("created"),   file.value(BR_CREATED).toDateTime().toLocalTime());
     res.insert(QLatin1String("repos"),     file.value(BR_REPO_ALL).toStringList().size());
     res.insert(QLatin1String("packages"),  file.value(BR_INSTALLED).toStringList().size());
-    res.insert(QLatin1String("bookmarks"), file.value(BR_BOOKMARKS).toStringList().size());
+    res.insert(QLatin1String("bookmarks"), file.value(BR_BOOKMARKS).toList().size());
 
     return res;
 }
@@ -72,8 +256,9 @@ void OrnBackup::backup(const QString &filePath)
     {
         qCritical() << "Failed to create directory" << dir.absolutePath();
         emit this->backupError(DirectoryError);
+        mFilePath.clear();
+        return;
     }
-    qDebug() << mFilePath;
     QtConcurrent::run(this, &OrnBackup::pBackup);
 }
 
@@ -88,23 +273,38 @@ void OrnBackup::restore(const QString &filePath)
         return;
     }
 
+    Snapshot snapshot;
+    if (!OrnBackup::pRead(filePath, snapshot))
+    {
+        return;
+    }
+
     mFilePath = filePath;
-    auto watcher = new QFutureWatcher<void>();
-    connect(watcher, &QFutureWatcher<void>::finished, this, &OrnBackup::pRefreshRepos);
-    watcher->setFuture(QtConcurrent::run(this, &OrnBackup::pRestore));
+    mNotFound.clear();
+    mFailedRepos.clear();
+    mPackagesToInstall.clear();
+    mNamesToSearch = snapshot.installed;
+
+    // Index the solv caches which are already on disk while the repos
+    // are being restored so only the refreshed ones are reread later
+    auto d = OrnPm::instance()->d_ptr;
+    QtConcurrent::run([d]()
+    {
+        d->packageIndex.update(d->sysInfo->archs());
+    });
+
+    this->pRestoreBookmarks(snapshot.bookmarks);
+    this->pRestoreRepos(snapshot.repos, snapshot.disabled);
 }
 
 QStringList OrnBackup::notFound() const
 {
-    QStringList names;
-    for (const auto &name : mPackagesToInstall.keys())
-    {
-        if (!mNamesToSearch.contains(name))
-        {
-            names << name;
-        }
-    }
-    return names;
+    return mNotFound;
+}
+
+QStringList OrnBackup::failedRepos() const
+{
+    return mFailedRepos;
 }
 
 bool OrnBackup::removeFile(const QString &filePath)
@@ -113,203 +313,490 @@ bool OrnBackup::removeFile(const QString &filePath)
     return QFile(filePath).remove();
 }
 
-void OrnBackup::pSearchPackages()
+OrnBackup::Snapshot OrnBackup::pCollect()
 {
-    qDebug() << "Searching packages";
-    this->setStatus(SearchingPackages);
-
-    // Delete future watcher and prepare variables
-    this->sender()->deleteLater();
-    mPackagesToInstall.clear();
-    mSearchIndex = 0;
+    auto d = OrnPm::instance()->d_ptr;
+    Snapshot snapshot;
+    snapshot.created = QDateTime::currentDateTimeUtc();
 
-    auto t = new PackageKit::Transaction();
-    connect(t, &PackageKit::Transaction::errorCode, mZypp, &OrnZypp::pkError);
-    connect(t, &PackageKit::Transaction::package, this, &OrnBackup::pAddPackage);
-    // It seems that the PackageKit::Transaction::searchNames(QStringList, ...)
-    // does searches only for the first name so we use this hack
-    connect(t, &PackageKit::Transaction::finished, [this, t]()
+    auto prefixSize = OrnPm::repoNamePrefix.size();
+    for (auto it = d->repos.cbegin(); it != d->repos.cend(); ++it)
     {
-        ++mSearchIndex;
-        if (mSearchIndex < mNamesToSearch.size())
+        auto author = it.key().mid(prefixSize);
+        snapshot.repos << author;
+        if (!it.value())
         {
-            t->reset();
-            t->searchNames(mNamesToSearch[mSearchIndex]);
+            snapshot.disabled << author;
         }
-        else
+    }
+
+    // Save only the packages available in ORN repos
+    d->packageIndex.update(d->sysInfo->archs());
+    for (auto it = d->installedPackages.cbegin(); it != d->installedPackages.cend(); ++it)
+    {
+        if (!d->packageIndex.find(it.key()).isEmpty())
         {
-            t->deleteLater();
-            this->pInstallPackages();
+            snapshot.installed << it.key();
         }
-    });
-    t->searchNames(mNamesToSearch[mSearchIndex]);
+    }
+
+    snapshot.bookmarks = OrnClient::instance()->mBookmarks.toList();
+    return snapshot;
 }
 
-void OrnBackup::pAddPackage(int info, const QString &packageId, const QString &summary)
+bool OrnBackup::pWrite(const QString &filePath, const Snapshot &snapshot)
 {
-    Q_UNUSED(info)
-    Q_UNUSED(summary)
-    auto idParts = packageId.split(QChar(';'));
-    auto name = idParts.first();
-    if (mNamesToSearch.contains(name))
-    {
-        auto repo = idParts.last();
-        // Process only packages from OpenRepos
-        if (repo.startsWith(OrnZypp::repoNamePrefix))
-        {
-            // We will filter the newest versions later
-            mPackagesToInstall.insert(name, packageId);
-        }
-        else if (repo == QStringLiteral("installed"))
+    auto serialize = [](quint16 id, const Snapshot &snapshot) -> QByteArray
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(BR_STREAM_VERSION);
+        switch (id)
         {
-            mInstalled.insert(name, idParts[1]);
+        case BR_SECTION_META:
+            stream << snapshot.created << snapshot.hash()
+                   << quint32(snapshot.repos.size())
+                   << quint32(snapshot.installed.size())
+                   << quint32(snapshot.bookmarks.size());
+            return data;
+        case BR_SECTION_REPOS:
+            stream << snapshot.repos << snapshot.disabled;
+            break;
+        case BR_SECTION_PACKAGES:
+            stream << snapshot.installed;
+            break;
+        case BR_SECTION_BOOKMARKS:
+            stream << snapshot.bookmarks;
+            break;
+        default:
+            Q_UNREACHABLE();
         }
+        return qCompress(data);
+    };
+
+    QList<quint16> ids{ BR_SECTION_META, BR_SECTION_REPOS,
+                        BR_SECTION_PACKAGES, BR_SECTION_BOOKMARKS };
+    QList<QByteArray> sections;
+    for (auto id : ids)
+    {
+        sections << serialize(id, snapshot);
+    }
+
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly))
+    {
+        qCritical() << "Could not write backup file" << filePath;
+        return false;
     }
+
+    QDataStream stream(&file);
+    stream.setVersion(BR_STREAM_VERSION);
+    stream << BR_MAGIC << BR_VERSION << quint16(ids.size());
+    // Header: magic + version + count + index entries
+    quint32 offset = 4 + 2 + 2 + ids.size() * (2 + 4 + 4);
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        quint32 size = sections[i].size();
+        stream << ids[i] << offset << size;
+        offset += size;
+    }
+    for (const auto &section : sections)
+    {
+        stream.writeRawData(section.constData(), section.size());
+    }
+    file.close();
+    if (stream.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        qCritical() << "Could not write backup file" << filePath << "-" << file.errorString();
+        return false;
+    }
+    return true;
 }
 
-void OrnBackup::pInstallPackages()
+bool OrnBackup::pRead(const QString &filePath, Snapshot &snapshot)
 {
-    qDebug() << "Installing packages";
-    this->setStatus(InstallingPackages);
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly))
+    {
+        qCritical() << "Could not read backup file" << filePath;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(BR_STREAM_VERSION);
+    quint32 magic;
+    quint16 version;
+    quint16 count;
+    stream >> magic >> version >> count;
+    if (magic != BR_MAGIC)
+    {
+        file.close();
+        qDebug() << "Reading legacy backup file" << filePath;
+        QSettings ini(filePath, QSettings::IniFormat);
+        snapshot.created   = ini.value(BR_CREATED).toDateTime();
+        snapshot.repos     = ini.value(BR_REPO_ALL).toStringList();
+        snapshot.disabled  = ini.value(BR_REPO_DISABLED).toStringList();
+        snapshot.installed = ini.value(BR_INSTALLED).toStringList();
+        for (const auto &b : ini.value(BR_BOOKMARKS).toList())
+        {
+            snapshot.bookmarks << b.toUInt();
+        }
+        return true;
+    }
 
-    QStringList ids;
-    for (const auto &pname : mPackagesToInstall.uniqueKeys())
+    if (version > BR_VERSION)
     {
-        const auto &pids = mPackagesToInstall.values(pname);
-        QString newestId;
-        OrnVersion newestVersion;
-        for (const auto &pid : pids)
+        qWarning() << "Unsupported backup version" << version;
+        return false;
+    }
+
+    QList<QPair<quint16, QPair<quint32, quint32>>> index;
+    for (quint16 i = 0; i < count; ++i)
+    {
+        quint16 id;
+        quint32 offset;
+        quint32 size;
+        stream >> id >> offset >> size;
+        index << qMakePair(id, qMakePair(offset, size));
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        qCritical() << "Backup file index is corrupted" << filePath;
+        return false;
+    }
+
+    for (const auto &entry : index)
+    {
+        auto size = entry.second.second;
+        if (!file.seek(entry.second.first))
+        {
+            qCritical() << "Backup file section" << entry.first << "is out of range" << filePath;
+            return false;
+        }
+        auto data = file.read(size);
+        if (quint32(data.size()) != size)
+        {
+            qCritical() << "Backup file section" << entry.first << "is truncated" << filePath;
+            return false;
+        }
+        if (entry.first == BR_SECTION_META)
         {
-            OrnVersion v(PackageKit::Transaction::packageVersion(pid));
-            if (v > newestVersion)
+            QDataStream meta(data);
+            meta.setVersion(BR_STREAM_VERSION);
+            meta >> snapshot.created;
+            if (meta.status() != QDataStream::Ok)
             {
-                newestVersion = v;
-                newestId = pid;
+                qCritical() << "Backup file meta section is corrupted" << filePath;
+                return false;
             }
+            continue;
         }
-        // Skip packages that are already installed
-        if (!mInstalled.contains(pname) || OrnVersion(mInstalled[pname]) < newestVersion)
+        QDataStream section(qUncompress(data));
+        section.setVersion(BR_STREAM_VERSION);
+        switch (entry.first)
         {
-            ids << newestId;
+        case BR_SECTION_REPOS:
+            section >> snapshot.repos >> snapshot.disabled;
+            break;
+        case BR_SECTION_PACKAGES:
+            section >> snapshot.installed;
+            break;
+        case BR_SECTION_BOOKMARKS:
+            section >> snapshot.bookmarks;
+            break;
+        default:
+            // Skip sections of the newer minor versions
+            continue;
+        }
+        if (section.status() != QDataStream::Ok)
+        {
+            qCritical() << "Backup file section" << entry.first << "is corrupted" << filePath;
+            return false;
         }
     }
+    return true;
+}
 
-    if (ids.isEmpty())
+void OrnBackup::pBackup()
+{
+    qDebug() << "Starting backing up";
+    this->setStatus(BackingUp);
+    if (OrnBackup::pWrite(mFilePath, OrnBackup::pCollect()))
     {
-        this->pFinishRestore();
+        mFilePath.clear();
+        this->setStatus(Idle);
+        qDebug() << "Finished backing up";
+        emit this->backedUp();
     }
     else
     {
-        auto t = mZypp->transaction();
-        connect(t, &PackageKit::Transaction::finished, this, &OrnBackup::pFinishRestore);
-        t->installPackages(ids);
+        // Do not leave a partial file behind
+        QFile::remove(mFilePath);
+        mFilePath.clear();
+        this->setStatus(Idle);
+        emit this->backupError(WriteError);
     }
 }
 
-void OrnBackup::pFinishRestore()
+void OrnBackup::pBackupIfChanged(const QString &filePath)
 {
-    qDebug() << "Finished restoring";
-    mFilePath.clear();
-    this->setStatus(Idle);
-    emit this->restored();
-}
+    auto snapshot = OrnBackup::pCollect();
+    auto hash = snapshot.hash();
 
-void OrnBackup::pBackup()
-{
-    qDebug() << "Starting backing up";
+    QSettings settings;
+    if (settings.value(BR_AUTO_HASH).toByteArray() == hash &&
+        QFileInfo(settings.value(BR_AUTO_FILE).toString()).isFile())
+    {
+        qDebug() << "Nothing has changed since the last scheduled backup";
+        return;
+    }
+
+    qDebug() << "Starting scheduled backup to" << filePath;
     this->setStatus(BackingUp);
-    QSettings file(mFilePath, QSettings::IniFormat);
-    QStringList repos;
-    QStringList disabled;
-    QSet<QString> ornPackages;
+    if (OrnBackup::pWrite(filePath, snapshot))
+    {
+        settings.setValue(BR_AUTO_HASH, hash);
+        settings.setValue(BR_AUTO_FILE, filePath);
+        OrnBackup::pPruneAutoBackups(QFileInfo(filePath).dir());
+        qDebug() << "Finished scheduled backup";
+        this->setStatus(Idle);
+        emit this->backedUp();
+    }
+    else
+    {
+        // Do not leave a partial file behind
+        QFile::remove(filePath);
+        this->setStatus(Idle);
+        emit this->backupError(WriteError);
+    }
+}
 
-    for (auto it = mZypp->mRepos.cbegin(); it != mZypp->mRepos.cend(); ++it)
+void OrnBackup::pPruneAutoBackups(const QDir &dir)
+{
+    // The names are timestamps so the newest files go first
+    auto files = dir.entryList(QStringList(BR_AUTO_PATTERN), QDir::Files, QDir::Name | QDir::Reversed);
+    for (int i = BR_AUTO_KEEP; i < files.size(); ++i)
     {
-        auto author = it.key().mid(OrnZypp::repoNamePrefixLength);
-        repos << author;
-        auto repo = it.value();
-        if (!repo.enabled)
+        auto path = dir.absoluteFilePath(files[i]);
+        qDebug() << "Removing old scheduled backup" << path;
+        if (!QFile::remove(path))
         {
-            disabled << author;
+            qWarning() << "Could not remove old scheduled backup" << path;
         }
-        for (const auto &package : repo.packages)
+    }
+}
+
+void OrnBackup::pRestoreBookmarks(const QList<quint32> &bookmarks)
+{
+    qDebug() << "Restoring bookmarks";
+    this->setStatus(RestoringBookmarks);
+    auto client = OrnClient::instance();
+    bool changed = false;
+    for (const auto &appId : bookmarks)
+    {
+        if (!client->mBookmarks.contains(appId))
         {
-            ornPackages.insert(package);
+            client->mBookmarks.insert(appId);
+            emit client->bookmarkChanged(appId, true);
+            changed = true;
         }
     }
+    if (changed)
+    {
+        emit client->bookmarksChanged();
+    }
+}
 
-    qDebug() << "Backing up repos";
-    file.setValue(BR_REPO_ALL, repos);
-    file.setValue(BR_REPO_DISABLED, disabled);
+void OrnBackup::pRestoreRepos(const QStringList &authors, const QStringList &disabled)
+{
+    qDebug() << "Restoring repos";
+    this->setStatus(RestoringRepos);
 
-    qDebug() << "Backing up installed packages";
-    QStringList installed;
-    for (const auto &name :  mZypp->mInstalledPackages.uniqueKeys())
+    auto d = OrnPm::instance()->d_ptr;
+    auto disabledSet = disabled.toSet();
+
+    // Issue all the calls at once and wait for them all to finish
+    mPendingRepoCalls = 0;
+    for (const auto &author : authors)
     {
-        if (ornPackages.contains(name))
+        auto alias = OrnPm::repoNamePrefix + author;
+        if (d->repos.contains(alias) || d->operations.contains(alias))
         {
-            installed << name;
+            continue;
         }
+        auto enabled = !disabledSet.contains(author);
+        // The SSU config watcher would take the repo for an external
+        // change and refresh it before the restore does it in one go
+        d->setOperation(alias, OrnPm::AddingRepo);
+        auto watcher = d->ssuAddRepo(alias, this);
+        ++mPendingRepoCalls;
+        connect(watcher, &QDBusPendingCallWatcher::finished, [this, d, watcher, alias, enabled]()
+        {
+            watcher->deleteLater();
+            if (!d->ssuCallFinished(watcher, alias))
+            {
+                d->removeOperation(alias);
+                mFailedRepos << alias;
+                this->pRepoRestored();
+                return;
+            }
+            d->insertRepo(alias, true);
+            if (enabled)
+            {
+                d->removeOperation(alias);
+                this->pRepoRestored();
+                return;
+            }
+            // Keep the operation until the repo is disabled
+            d->setOperation(alias, OrnPm::DisablingRepo);
+            auto dwatcher = d->ssuModifyRepo(alias, OrnPm::DisableRepo, this);
+            connect(dwatcher, &QDBusPendingCallWatcher::finished, [this, d, dwatcher, alias]()
+            {
+                dwatcher->deleteLater();
+                if (d->ssuCallFinished(dwatcher, alias))
+                {
+                    // Also removes the operation
+                    d->onRepoModified(alias, OrnPm::DisableRepo);
+                }
+                else
+                {
+                    d->removeOperation(alias);
+                    mFailedRepos << alias;
+                }
+                this->pRepoRestored();
+            });
+        });
     }
-    file.setValue(BR_INSTALLED, installed);
 
-    qDebug() << "Backing up bookmarks";
-    QVariantList bookmarks;
-    for (const auto &b : OrnClient::instance()->mBookmarks)
+    if (mPendingRepoCalls == 0)
     {
-        bookmarks << b;
+        qDebug() << "All the repos are already added";
+        this->pRefreshRepos();
     }
-    file.setValue(BR_BOOKMARKS, bookmarks);
+}
 
-    file.setValue(BR_CREATED, QDateTime::currentDateTime().toUTC());
-    qDebug() << "Finished backing up";
-    mFilePath.clear();
-    this->setStatus(Idle);
-    emit this->backedUp();
+void OrnBackup::pRepoRestored()
+{
+    if (--mPendingRepoCalls == 0)
+    {
+        OrnPm::instance()->d_ptr->invalidatePool();
+        this->pRefreshRepos();
+    }
 }
 
-void OrnBackup::pRestore()
+void OrnBackup::pRefreshRepos()
 {
-    QSettings file(mFilePath, QSettings::IniFormat);
+    qDebug() << "Refreshing repos";
+    this->setStatus(RefreshingRepos);
+    // Refresh all the repos in a single transaction
+    auto t = OrnPm::instance()->d_ptr->transaction(PK_METHOD_REFRESHCACHE);
+    connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(pSearchPackages()));
+    qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REFRESHCACHE "(false)";
+    t->asyncCall(QStringLiteral(PK_METHOD_REFRESHCACHE), false);
+}
 
-    qDebug() << "Restoring bookmarks";
-    this->setStatus(RestoringBookmarks);
-    auto client = OrnClient::instance();
-    auto oldBookmarks = client->mBookmarks;
-    for (const auto &b : file.value(BR_BOOKMARKS).toList())
+void OrnBackup::pSearchPackages()
+{
+    qDebug() << "Searching packages";
+    this->setStatus(SearchingPackages);
+    auto d = OrnPm::instance()->d_ptr;
+    d->invalidatePool();
+
+    auto watcher = new QFutureWatcher<Resolved>(this);
+    connect(watcher, &QFutureWatcher<Resolved>::finished, [this, watcher]()
     {
-        client->mBookmarks.insert(b.toUInt());
-    }
-    if (oldBookmarks != client->mBookmarks)
+        watcher->deleteLater();
+        auto resolved = watcher->result();
+        mNotFound = resolved.notFound;
+        mPackagesToInstall = resolved.ids;
+        this->pInstallPackages();
+    });
+    // The package states are copied as OrnPm changes them in this thread
+    watcher->setFuture(QtConcurrent::run(&OrnBackup::pResolvePackages, mNamesToSearch,
+                                         d->repos, d->installedPackages));
+}
+
+OrnBackup::Resolved OrnBackup::pResolvePackages(const QStringList &names,
+                                                const QHash<QString, bool> &repos,
+                                                const QHash<QString, QString> &installed)
+{
+    auto d = OrnPm::instance()->d_ptr;
+    // Only the refreshed solv files are reread here
+    d->packageIndex.update(d->sysInfo->archs());
+
+    Resolved resolved;
+    for (const auto &name : names)
     {
-        emit client->bookmarksChanged();
+        // Versions are sorted from the newest one
+        OrnPackageVersion newest;
+        for (const auto &version : d->packageIndex.find(name))
+        {
+            if (repos.value(version.repoAlias))
+            {
+                newest = version;
+                break;
+            }
+        }
+
+        if (newest.version.isEmpty())
+        {
+            resolved.notFound << name;
+            continue;
+        }
+
+        // Skip packages that are already installed
+        if (installed.contains(name) &&
+            !(OrnPackageVersion(0, 0, installed[name], QString(), QString()) < newest))
+        {
+            continue;
+        }
+        resolved.ids << newest.packageId(name);
     }
 
-    qDebug() << "Restoring repos";
-    this->setStatus(RestoringRepos);
+    qDebug() << "Resolved" << resolved.ids.size() << "packages to install,"
+             << resolved.notFound.size() << "not found";
+    return resolved;
+}
 
-    auto repos = file.value(BR_REPO_ALL).toStringList();
-    auto disabled = file.value(BR_REPO_DISABLED).toStringList().toSet();
-    mNamesToSearch = file.value(BR_INSTALLED).toStringList();
+void OrnBackup::pInstallPackages()
+{
+    auto ornPm = OrnPm::instance();
+    if (!mPackagesToInstall.isEmpty())
+    {
+        // OrnPm skips the packages which are already being processed
+        mPackagesToInstall = ornPm->installPackages(mPackagesToInstall);
+    }
+    if (mPackagesToInstall.isEmpty())
+    {
+        this->pFinishRestore();
+        return;
+    }
+
+    qDebug() << "Installing packages";
+    this->setStatus(InstallingPackages);
+    connect(ornPm, &OrnPm::packagesInstalled, this, &OrnBackup::pPackagesInstalled,
+            Qt::UniqueConnection);
+}
 
-    for (const auto &author : repos)
+void OrnBackup::pPackagesInstalled(const QStringList &packageIds, bool success)
+{
+    // Skip the other batches
+    if (mStatus != InstallingPackages || packageIds != mPackagesToInstall)
+    {
+        return;
+    }
+    if (!success)
     {
-        auto alias = OrnZypp::repoNamePrefix + author;
-        auto call = QDBusMessage::createMethodCall(OrnZypp::ssuInterface, OrnZypp::ssuPath,
-                                                   OrnZypp::ssuInterface, OrnZypp::ssuAddRepo);
-        call.setArguments(QVariantList{ alias, OrnZypp::repoBaseUrl.arg(author) });
-        QDBusConnection::systemBus().call(call, QDBus::Block);
-        mZypp->mRepos.insert(alias, OrnZypp::RepoMeta(!disabled.contains(author)));
+        qWarning() << "Could not install the restored packages";
     }
+    this->pFinishRestore();
 }
 
-void OrnBackup::pRefreshRepos()
+void OrnBackup::pFinishRestore()
 {
-    qDebug() << "Refreshing repos";
-    this->setStatus(RefreshingRepos);
-    auto t = new PackageKit::Transaction();
-    connect(t, &PackageKit::Transaction::finished, t, &PackageKit::Transaction::deleteLater);
-    connect(t, &PackageKit::Transaction::errorCode, mZypp, &OrnZypp::pkError);
-    connect(t, &PackageKit::Transaction::finished, this, &OrnBackup::pSearchPackages);
-    t->refreshCache(false);
+    qDebug() << "Finished restoring";
+    mFilePath.clear();
+    mPackagesToInstall.clear();
+    this->setStatus(Idle);
+    emit this->restored();
 }
@@ -2,16 +2,19 @@
 #define ORNBACKUP_H
 
 #include <QObject>
-#include <QHash>
 #include <QVariant>
-#include <QSet>
+#include <QStringList>
+#include <QHash>
 
-class OrnZypp;
+class QTimer;
+class QDir;
 
 class OrnBackup : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+    Q_PROPERTY(QString autoBackupDir READ autoBackupDir WRITE setAutoBackupDir NOTIFY autoBackupChanged)
+    Q_PROPERTY(int autoBackupInterval READ autoBackupInterval WRITE setAutoBackupInterval NOTIFY autoBackupChanged)
 
 public:
 
@@ -30,18 +33,28 @@ public:
     enum Error
     {
         NoError,
-        DirectoryError
+        DirectoryError,
+        WriteError
     };
-    Q_ENUMS(Error)
+    Q_ENUM(Error)
 
-    explicit OrnBackup(QObject *parent = 0);
+    explicit OrnBackup(QObject *parent = nullptr);
 
     Status status() const;
 
+    QString autoBackupDir() const;
+    void setAutoBackupDir(const QString &dirPath);
+
+    /// The interval of scheduled backups in hours, 0 disables them
+    int autoBackupInterval() const;
+    void setAutoBackupInterval(int hours);
+
     Q_INVOKABLE static QVariantMap details(const QString &path);
     Q_INVOKABLE void backup(const QString &filePath);
     Q_INVOKABLE void restore(const QString &filePath);
     Q_INVOKABLE QStringList notFound() const;
+    /// The aliases of the repos which could not be restored
+    Q_INVOKABLE QStringList failedRepos() const;
     Q_INVOKABLE static bool removeFile(const QString &filePath);
 
 signals:
@@ -49,28 +62,49 @@ signals:
     void backupError(Error err);
     void backedUp();
     void restored();
+    void autoBackupChanged();
 
 private slots:
+    void pAutoBackup();
+    void pRefreshRepos();
     void pSearchPackages();
-    void pAddPackage(int info, const QString &packageId, const QString &summary);
     void pInstallPackages();
+    void pPackagesInstalled(const QStringList &packageIds, bool success);
     void pFinishRestore();
 
 private:
+    struct Snapshot;
+    /// The packages to install and the ones not found in the repos
+    struct Resolved
+    {
+        QStringList ids;
+        QStringList notFound;
+    };
+
     void setStatus(const Status &status);
+    void setAutoBackupTimer();
+    static Snapshot pCollect();
+    static bool pWrite(const QString &filePath, const Snapshot &snapshot);
+    static bool pRead(const QString &filePath, Snapshot &snapshot);
     void pBackup();
-    void pRestore();
-    void pRefreshRepos();
+    void pBackupIfChanged(const QString &filePath);
+    static void pPruneAutoBackups(const QDir &dir);
+    void pRestoreBookmarks(const QList<quint32> &bookmarks);
+    void pRestoreRepos(const QStringList &authors, const QStringList &disabled);
+    void pRepoRestored();
+    static Resolved pResolvePackages(const QStringList &names,
+                                     const QHash<QString, bool> &repos,
+                                     const QHash<QString, QString> &installed);
 
 private:
-    OrnZypp *mZypp;
     Status mStatus;
-    QStringList::size_type mSearchIndex;
+    int mPendingRepoCalls;
     QString mFilePath;
     QStringList mNamesToSearch;
-    // Name, version
-    QHash<QString, QString> mInstalled;
-    QMultiHash<QString, QString> mPackagesToInstall;
+    QStringList mNotFound;
+    QStringList mFailedRepos;
+    QStringList mPackagesToInstall;
+    QTimer *mAutoBackupTimer;
 };
 
 #endif // ORNBACKUP_H
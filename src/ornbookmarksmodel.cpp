@@ -1,9 +1,41 @@
 #include "ornbookmarksmodel.h"
 #include "ornapplication.h"
 #include "ornclient.h"
+#include "ornjsonreader.h"
+#include "orn.h"
+
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+
+#include <algorithm>
+
+// The maximum number of simultaneous summary requests
+#define MAX_REFRESHES 2
+// A failed summary request is queued again this many times
+#define MAX_REFRESH_RETRIES 3
+// Summaries older than this are refreshed, in secs
+#define SUMMARY_TTL (24 * 60 * 60)
+#define SUMMARIES_FILE "bookmarks-summaries"
+#define SUMMARIES_VERSION 1
+
+OrnBookmarksModel::Summary::Summary()
+    : appId(0)
+    , ratingCount(0)
+    , rating(0.0)
+    , refreshed(0)
+{
+
+}
 
 OrnBookmarksModel::OrnBookmarksModel(QObject *parent) :
-    OrnAbstractListModel(false, parent)
+    OrnAbstractListModel(false, parent),
+    mRefreshing(0),
+    mSummariesLoaded(false),
+    mSummariesChanged(false)
 {
     connect(OrnClient::instance(), &OrnClient::bookmarkChanged,
             this, &OrnBookmarksModel::onBookmarkChanged);
@@ -14,39 +46,334 @@ void OrnBookmarksModel::onBookmarkChanged(quint32 appId, bool bookmarked)
     if (bookmarked)
     {
         this->addApp(appId);
+        return;
     }
-    else
+
+    mRefreshQueue.removeAll(appId);
+    mRefreshFailures.remove(appId);
+    if (mSummaries.remove(appId) && mRefreshing == 0)
     {
-        auto s = mData.size();
-        for (int i = 0; i < s; ++i)
-        {
-            auto app = static_cast<OrnApplication *>(mData[i]);
-            if (app->mAppId == appId)
-            {
-                qDebug() << "Removing app" << appId << "from bookmarks model";
-                this->beginRemoveRows(QModelIndex(), i, i);
-                mData.removeAt(i);
-                this->endRemoveRows();
-                app->deleteLater();
-                return;
-            }
-        }
+        this->saveSummaries();
+    }
+    auto row = this->findRow(appId);
+    if (row != -1)
+    {
+        qDebug() << "Removing app" << appId << "from bookmarks model";
+        auto app = mData[row];
+        this->beginRemoveRows(QModelIndex(), row, row);
+        mData.removeAt(row);
+        this->endRemoveRows();
+        app->deleteLater();
     }
 }
 
 void OrnBookmarksModel::addApp(const quint32 &appId)
 {
     qDebug() << "Adding app" << appId << "to bookmarks model";
-    auto app = new OrnApplication(this);
-    app->setAppId(appId);
-    connect(app, &OrnApplication::ornRequestFinished, [=]()
+    this->loadSummaries();
+    // A new app gets a placeholder row until its summary arrives
+    this->insertApp(this->bookmarkSummary(appId));
+    this->queueRefresh(appId);
+    this->refreshNext();
+}
+
+int OrnBookmarksModel::findRow(quint32 appId) const
+{
+    auto s = mData.size();
+    for (int i = 0; i < s; ++i)
     {
-        auto s = mData.size();
-        this->beginInsertRows(QModelIndex(), s, s);
-        mData << app;
-        this->endInsertRows();
+        if (static_cast<OrnApplication *>(mData[i])->mAppId == appId)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool OrnBookmarksModel::titleLessThan(const QString &a, const QString &b)
+{
+    if (a.isEmpty())
+    {
+        return false;
+    }
+    return b.isEmpty() || QString::compare(a, b, Qt::CaseInsensitive) < 0;
+}
+
+int OrnBookmarksModel::sortedRow(const QString &title) const
+{
+    auto it = std::lower_bound(mData.cbegin(), mData.cend(), title,
+                               [](const QObject *item, const QString &title)
+    {
+        return titleLessThan(static_cast<const OrnApplication *>(item)->mTitle, title);
     });
-    app->ornRequest();
+    return int(it - mData.cbegin());
+}
+
+OrnBookmarksModel::Summary OrnBookmarksModel::bookmarkSummary(quint32 appId) const
+{
+    auto it = mSummaries.constFind(appId);
+    if (it != mSummaries.cend())
+    {
+        return it.value();
+    }
+    Summary placeholder;
+    placeholder.appId = appId;
+    return placeholder;
+}
+
+OrnApplication *OrnBookmarksModel::createApp(const Summary &summary)
+{
+    auto app = new OrnApplication(this);
+    app->mAppId = summary.appId;
+    app->mTitle = summary.title;
+    app->mUserName = summary.userName;
+    app->mIconSource = summary.iconSource;
+    app->mRating = summary.rating;
+    app->mRatingCount = summary.ratingCount;
+    return app;
+}
+
+void OrnBookmarksModel::insertApp(const Summary &summary)
+{
+    if (this->findRow(summary.appId) != -1)
+    {
+        return;
+    }
+    auto app = this->createApp(summary);
+    auto row = this->sortedRow(summary.title);
+    this->beginInsertRows(QModelIndex(), row, row);
+    mData.insert(row, app);
+    this->endInsertRows();
+}
+
+void OrnBookmarksModel::updateApp(int row, const Summary &summary)
+{
+    auto app = static_cast<OrnApplication *>(mData[row]);
+    if (app->mTitle == summary.title && app->mUserName == summary.userName &&
+        app->mIconSource == summary.iconSource && app->mRating == summary.rating &&
+        app->mRatingCount == summary.ratingCount)
+    {
+        return;
+    }
+
+    auto titleChanged = app->mTitle != summary.title;
+    app->mTitle = summary.title;
+    app->mUserName = summary.userName;
+    app->mIconSource = summary.iconSource;
+    app->mRating = summary.rating;
+    app->mRatingCount = summary.ratingCount;
+    // Notify the bindings to the summary properties
+    emit app->ornRequestFinished();
+
+    if (titleChanged)
+    {
+        // Keep the rows sorted
+        mData.removeAt(row);
+        auto dest = this->sortedRow(summary.title);
+        mData.insert(row, app);
+        if (dest != row)
+        {
+            this->beginMoveRows(QModelIndex(), row, row, QModelIndex(), dest > row ? dest + 1 : dest);
+            mData.move(row, dest);
+            this->endMoveRows();
+            row = dest;
+        }
+    }
+    auto index = this->index(row);
+    emit this->dataChanged(index, index);
+}
+
+void OrnBookmarksModel::queueRefresh(quint32 appId)
+{
+    auto it = mSummaries.constFind(appId);
+    auto now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    if (it != mSummaries.cend() && now - it->refreshed < SUMMARY_TTL)
+    {
+        return;
+    }
+    if (!mRefreshQueue.contains(appId))
+    {
+        mRefreshQueue << appId;
+    }
+}
+
+void OrnBookmarksModel::refreshNext()
+{
+    while (mRefreshing < MAX_REFRESHES && !mRefreshQueue.isEmpty())
+    {
+        auto appId = mRefreshQueue.takeFirst();
+        auto request = new OrnApiRequest(this);
+        request->setPriority(OrnApiRequest::BackgroundPriority);
+        connect(request, &OrnApiRequest::jsonReady, this, [this, request, appId](const QByteArray &json)
+        {
+            request->deleteLater();
+            if (this->onSummaryReady(appId, json))
+            {
+                mRefreshFailures.remove(appId);
+            }
+            else
+            {
+                this->onRefreshFailed(appId);
+            }
+            this->onRefreshFinished();
+        });
+        connect(request, &OrnApiRequest::failed, this, [this, request, appId]()
+        {
+            request->deleteLater();
+            this->onRefreshFailed(appId);
+            this->onRefreshFinished();
+        });
+
+        ++mRefreshing;
+        auto networkRequest = OrnApiRequest::networkRequest();
+        networkRequest.setUrl(OrnApiRequest::apiUrl(QStringLiteral("apps/%0").arg(appId)));
+        request->run(networkRequest);
+    }
+}
+
+void OrnBookmarksModel::onRefreshFinished()
+{
+    --mRefreshing;
+    this->refreshNext();
+    if (mRefreshing == 0 && mSummariesChanged)
+    {
+        this->saveSummaries();
+    }
+}
+
+void OrnBookmarksModel::onRefreshFailed(quint32 appId)
+{
+    if (!OrnClient::instance()->hasBookmark(appId))
+    {
+        mRefreshFailures.remove(appId);
+        return;
+    }
+    auto &failures = mRefreshFailures[appId];
+    if (++failures > MAX_REFRESH_RETRIES)
+    {
+        // Try again when the model or the bookmark is loaded next time
+        qWarning() << "Giving up refreshing the summary of app" << appId;
+        mRefreshFailures.remove(appId);
+        return;
+    }
+    // Let the other summaries go first
+    if (!mRefreshQueue.contains(appId))
+    {
+        mRefreshQueue << appId;
+    }
+}
+
+bool OrnBookmarksModel::onSummaryReady(quint32 appId, const QByteArray &json)
+{
+    typedef OrnJsonField<Summary> Field;
+    static const Field userFields[] = {
+        { "name", [](OrnJsonReader &r, Summary &s) { s.userName = r.readString(); } }
+    };
+    static const Field iconFields[] = {
+        { "url", [](OrnJsonReader &r, Summary &s) { s.iconSource = r.readString(); } }
+    };
+    static const Field ratingFields[] = {
+        { "count",  [](OrnJsonReader &r, Summary &s) { s.ratingCount = r.readUint(); } },
+        { "rating", [](OrnJsonReader &r, Summary &s) { s.rating = r.readFloat(); } }
+    };
+    static const Field fields[] = {
+        { "title",  [](OrnJsonReader &r, Summary &s) { s.title = r.readString(); } },
+        { "user",   [](OrnJsonReader &r, Summary &s) { r.decode(s, userFields); } },
+        { "icon",   [](OrnJsonReader &r, Summary &s) { r.decode(s, iconFields); } },
+        { "rating", [](OrnJsonReader &r, Summary &s) { r.decode(s, ratingFields); } }
+    };
+
+    if (!OrnClient::instance()->hasBookmark(appId))
+    {
+        return true;
+    }
+
+    Summary summary;
+    OrnJsonReader reader(json);
+    if (!reader.decode(summary, fields) || summary.title.isEmpty())
+    {
+        qWarning() << "Could not read the summary of app" << appId;
+        return false;
+    }
+    summary.appId = appId;
+    summary.refreshed = QDateTime::currentMSecsSinceEpoch() / 1000;
+    mSummaries.insert(appId, summary);
+    mSummariesChanged = true;
+
+    auto row = this->findRow(appId);
+    if (row == -1)
+    {
+        this->insertApp(summary);
+    }
+    else
+    {
+        this->updateApp(row, summary);
+    }
+    return true;
+}
+
+void OrnBookmarksModel::loadSummaries()
+{
+    if (mSummariesLoaded)
+    {
+        return;
+    }
+    mSummariesLoaded = true;
+
+    auto path = QStandardPaths::locate(
+                QStandardPaths::AppLocalDataLocation, QStringLiteral(SUMMARIES_FILE));
+    if (path.isEmpty())
+    {
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+    {
+        qWarning() << "Could not read bookmark summaries file" << path;
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint8 version = 0;
+    quint32 count = 0;
+    stream >> version >> count;
+    if (version != SUMMARIES_VERSION)
+    {
+        qWarning() << "Unsupported bookmark summaries version" << version;
+        return;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        Summary summary;
+        stream >> summary.appId >> summary.title >> summary.userName >> summary.iconSource
+               >> summary.rating >> summary.ratingCount >> summary.refreshed;
+        mSummaries.insert(summary.appId, summary);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        qWarning() << "Bookmark summaries file is corrupted" << path;
+        mSummaries.clear();
+    }
+    qDebug() << "Read" << mSummaries.size() << "bookmark summaries";
+}
+
+void OrnBookmarksModel::saveSummaries()
+{
+    mSummariesChanged = false;
+    QSaveFile file(Orn::locate(QStringLiteral(SUMMARIES_FILE)));
+    if (!file.open(QFile::WriteOnly))
+    {
+        qWarning() << "Could not write bookmark summaries file" << file.fileName();
+        return;
+    }
+    QDataStream stream(&file);
+    stream << quint8(SUMMARIES_VERSION) << quint32(mSummaries.size());
+    for (const auto &summary : mSummaries)
+    {
+        stream << summary.appId << summary.title << summary.userName << summary.iconSource
+               << summary.rating << summary.ratingCount << summary.refreshed;
+    }
+    file.commit();
 }
 
 QVariant OrnBookmarksModel::data(const QModelIndex &index, int role) const
@@ -64,6 +391,11 @@ QVariant OrnBookmarksModel::data(const QModelIndex &index, int role) const
     case SortRole:
         return app->mTitle;
     case SectionRole:
+        // The placeholders have no title yet
+        if (app->mTitle.isEmpty())
+        {
+            return QString();
+        }
         return app->mTitle.at(0).toUpper();
     default:
         return QVariant();
@@ -76,11 +408,37 @@ void OrnBookmarksModel::fetchMore(const QModelIndex &parent)
     {
         return;
     }
-    for (const auto &appid : OrnClient::instance()->bookmarks())
+    mCanFetchMore = false;
+    this->loadSummaries();
+
+    // Show the stored summaries and the placeholders at once
+    QObjectList apps;
+    auto empty = mData.isEmpty();
+    for (const auto &appId : OrnClient::instance()->bookmarks())
     {
-        this->addApp(appid);
+        if (empty)
+        {
+            apps << this->createApp(this->bookmarkSummary(appId));
+        }
+        else
+        {
+            this->insertApp(this->bookmarkSummary(appId));
+        }
+        this->queueRefresh(appId);
     }
-    mCanFetchMore = false;
+    if (!apps.isEmpty())
+    {
+        std::stable_sort(apps.begin(), apps.end(), [](const QObject *a, const QObject *b)
+        {
+            return titleLessThan(static_cast<const OrnApplication *>(a)->mTitle,
+                                 static_cast<const OrnApplication *>(b)->mTitle);
+        });
+        this->beginInsertRows(QModelIndex(), 0, apps.size() - 1);
+        mData = apps;
+        qDebug() << apps.size() << "bookmarks have been added to the model";
+        this->endInsertRows();
+    }
+    this->refreshNext();
 }
 
 QHash<int, QByteArray> OrnBookmarksModel::roleNames() const
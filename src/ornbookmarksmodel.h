@@ -3,6 +3,18 @@
 
 #include "ornabstractlistmodel.h"
 
+#include <QHash>
+
+class OrnApplication;
+
+/**
+ * @brief The model of the bookmarked apps
+ * The rows are created from the app summaries stored between the runs
+ * and kept sorted by title. The apps without a summary get placeholder
+ * rows at the end until it arrives. The stale and missing summaries are
+ * refreshed with a few background requests at a time, the full app details
+ * are loaded only when OrnApplication::ornRequest() is called for a row.
+ */
 class OrnBookmarksModel : public OrnAbstractListModel
 {
     Q_OBJECT
@@ -23,6 +35,47 @@ private slots:
     void onBookmarkChanged(quint32 appId, bool bookmarked);
     void addApp(const quint32 &appId);
 
+private:
+    /// The list data of a bookmarked app
+    struct Summary
+    {
+        Summary();
+
+        quint32 appId;
+        quint32 ratingCount;
+        float rating;
+        QString title;
+        QString userName;
+        QString iconSource;
+        /// Secs since epoch
+        qint64 refreshed;
+    };
+
+    /// Compare the titles case insensitively, the empty ones go last
+    static bool titleLessThan(const QString &a, const QString &b);
+    OrnApplication *createApp(const Summary &summary);
+    int findRow(quint32 appId) const;
+    int sortedRow(const QString &title) const;
+    /// Returns the stored summary or a placeholder with the app id only
+    Summary bookmarkSummary(quint32 appId) const;
+    void insertApp(const Summary &summary);
+    void updateApp(int row, const Summary &summary);
+    void queueRefresh(quint32 appId);
+    void refreshNext();
+    void onRefreshFinished();
+    void onRefreshFailed(quint32 appId);
+    bool onSummaryReady(quint32 appId, const QByteArray &json);
+    void loadSummaries();
+    void saveSummaries();
+
+    QHash<quint32, Summary> mSummaries;
+    QList<quint32> mRefreshQueue;
+    // <app id, failed refreshes>
+    QHash<quint32, int> mRefreshFailures;
+    int mRefreshing;
+    bool mSummariesLoaded;
+    bool mSummariesChanged;
+
     // QAbstractItemModel interface
 public:
     QVariant data(const QModelIndex &index, int role) const;
@@ -31,7 +84,7 @@ public:
 
     // OrnAbstractListModel interface
 protected slots:
-    void onJsonReady(const QJsonDocument &jsonDoc) { Q_UNUSED(jsonDoc) }
+    void onJsonReady(const QByteArray &json) { Q_UNUSED(json) }
 };
 
 #endif // ORNBOOKMARKSMODEL_H
@@ -4,9 +4,6 @@
 
 #include <QUrl>
 #include <QNetworkRequest>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 
 OrnCategoriesModel::OrnCategoriesModel(QObject *parent) :
     OrnAbstractListModel(false, parent)
@@ -38,25 +35,51 @@ QHash<int, QByteArray> OrnCategoriesModel::roleNames() const
     return { { Qt::DisplayRole, "categoryData" } };
 }
 
-void OrnCategoriesModel::onJsonReady(const QJsonDocument &jsonDoc)
+QByteArray OrnCategoriesModel::categoryKey(const OrnCategoryListItem *category)
 {
-    auto categoriesArray = jsonDoc.array();
-    if (categoriesArray.isEmpty())
+    return QByteArray::number(category->mTid)
+            .append(':').append(QByteArray::number(category->mAppsCount))
+            .append(':').append(QByteArray::number(category->mDepth));
+}
+
+void OrnCategoriesModel::onJsonReady(const QByteArray &json)
+{
+    QObjectList list;
+    OrnJsonReader reader(json);
+    if (reader.beginArray())
+    {
+        while (reader.nextElement())
+        {
+            list << OrnCategoryListItem::parse(reader, this);
+        }
+    }
+    if (list.isEmpty())
     {
         qWarning() << "Api reply is empty";
         return;
     }
-
-    QObjectList list;
-    for (const auto &category: categoriesArray)
+    if (mData.isEmpty())
     {
-        list << OrnCategoryListItem::parse(category.toObject(), this);
+        this->beginInsertRows(QModelIndex(), 0, list.size() - 1);
+        mData = list;
+        qDebug() << list.size() << "items have been added to the model";
+        this->endInsertRows();
+    }
+    else
+    {
+        // Revalidate the stored copy
+        QByteArrayList oldKeys;
+        QByteArrayList newKeys;
+        for (const auto &item : mData)
+        {
+            oldKeys << categoryKey(static_cast<OrnCategoryListItem *>(item));
+        }
+        for (const auto &item : list)
+        {
+            newKeys << categoryKey(static_cast<OrnCategoryListItem *>(item));
+        }
+        this->updateRows(0, mData.size(), list, oldKeys, newKeys);
     }
-    this->beginInsertRows(QModelIndex(), 0, list.size() - 1);
-    mData = list;
-    qDebug() << list.size() << "items have been added to the model";
-    this->endInsertRows();
     emit this->replyProcessed();
     mCanFetchMore = false;
 }
-
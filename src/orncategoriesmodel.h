@@ -3,6 +3,8 @@
 
 #include "ornabstractlistmodel.h"
 
+class OrnCategoryListItem;
+
 /**
  * @brief The categories model class
  * This will work properly only if api response contains sorted categories
@@ -21,7 +23,10 @@ public:
 
     // OrnAbstractListModel interface
 protected slots:
-    void onJsonReady(const QJsonDocument &jsonDoc);
+    void onJsonReady(const QByteArray &json);
+
+private:
+    static QByteArray categoryKey(const OrnCategoryListItem *category);
 };
 
 #endif // ORNCATEGORIESMODEL_H
@@ -1,10 +1,5 @@
 #include "orncategorylistitem.h"
-#include "orn.h"
-#include "ornapirequest.h"
-
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonValue>
+#include "ornjsonreader.h"
 
 #include <QDebug>
 
@@ -83,11 +78,11 @@ OrnCategoryListItem::OrnCategoryListItem(QObject *parent) :
     Q_ASSERT_X(false, Q_FUNC_INFO, "This constructor is only for moc");
 }
 
-OrnCategoryListItem::OrnCategoryListItem(const QJsonObject &jsonObject, QObject *parent) :
+OrnCategoryListItem::OrnCategoryListItem(quint32 tid, quint32 appsCount, quint32 depth, QObject *parent) :
     QObject(parent),
-    mTid(Orn::toUint(jsonObject[QStringLiteral("tid")])),
-    mAppsCount(Orn::toUint(jsonObject[QStringLiteral("apps_count")])),
-    mDepth(jsonObject[QStringLiteral("depth")].toVariant().toUInt()),
+    mTid(tid),
+    mAppsCount(appsCount),
+    mDepth(depth),
     mName(categoryName(mTid))
 {
 
@@ -108,24 +103,45 @@ QString OrnCategoryListItem::categoryName(const quint32 &tid)
     }
 }
 
-QObjectList OrnCategoryListItem::parse(const QJsonObject &jsonObject, QObject *parent)
+QObjectList OrnCategoryListItem::parse(OrnJsonReader &reader, QObject *parent)
 {
-    QObjectList list;
-    QString childrenKey(QStringLiteral("childrens"));
-    if (jsonObject.contains(childrenKey))
+    struct Category
     {
-        auto childrenArray = jsonObject[childrenKey].toArray();
-        for (const auto &child: childrenArray)
-        {
-            list << OrnCategoryListItem::parse(child.toObject(), parent);
+        quint32 tid;
+        quint32 appsCount;
+        quint32 depth;
+        QObjectList children;
+        QObject *parent;
+    } category = { 0, 0, 0, QObjectList(), parent };
+
+    static const OrnJsonField<Category> fields[] = {
+        { "tid",        [](OrnJsonReader &r, Category &c) { c.tid = r.readUint(); } },
+        { "apps_count", [](OrnJsonReader &r, Category &c) { c.appsCount = r.readUint(); } },
+        { "depth",      [](OrnJsonReader &r, Category &c) { c.depth = r.readUint(); } },
+        { "childrens",  [](OrnJsonReader &r, Category &c)
+            {
+                if (r.beginArray())
+                {
+                    while (r.nextElement())
+                    {
+                        c.children << OrnCategoryListItem::parse(r, c.parent);
+                    }
+                }
+            }
         }
-        std::sort(list.begin(), list.end(), [](QObject *a, QObject *b)
-        {
-            return static_cast<OrnCategoryListItem *>(a)->mName <
-                    static_cast<OrnCategoryListItem *>(b)->mName;
-        });
+    };
 
+    if (!reader.decode(category, fields))
+    {
+        return category.children;
     }
-    list.prepend(new OrnCategoryListItem(jsonObject, parent));
+
+    auto &list = category.children;
+    std::sort(list.begin(), list.end(), [](QObject *a, QObject *b)
+    {
+        return static_cast<OrnCategoryListItem *>(a)->mName <
+                static_cast<OrnCategoryListItem *>(b)->mName;
+    });
+    list.prepend(new OrnCategoryListItem(category.tid, category.appsCount, category.depth, parent));
     return list;
 }
@@ -3,6 +3,8 @@
 
 #include <QObject>
 
+class OrnJsonReader;
+
 class OrnCategoryListItem : public QObject
 {
     friend class OrnCategoriesModel;
@@ -15,12 +17,12 @@ class OrnCategoryListItem : public QObject
 
 public:
     explicit OrnCategoryListItem(QObject *parent = nullptr);
-    OrnCategoryListItem(const QJsonObject &jsonObject, QObject *parent = nullptr);
+    OrnCategoryListItem(quint32 tid, quint32 appsCount, quint32 depth, QObject *parent = nullptr);
 
     static QString categoryName(const quint32 &tid);
 
 private:
-    static QObjectList parse(const QJsonObject &jsonObject, QObject *parent = nullptr);
+    static QObjectList parse(OrnJsonReader &reader, QObject *parent = nullptr);
 
 private:
     quint32 mTid;
@@ -1,8 +1,8 @@
 #include "orncommentlistitem.h"
-#include "orn.h"
+#include "ornjsonreader.h"
 
-#include <QJsonObject>
 #include <QTimer>
+#include <QDateTime>
 
 OrnCommentListItem::OrnCommentListItem(QObject *parent) :
     QObject(parent)
@@ -10,19 +10,33 @@ OrnCommentListItem::OrnCommentListItem(QObject *parent) :
     Q_ASSERT_X(false, Q_FUNC_INFO, "This constructor is only for moc");
 }
 
-OrnCommentListItem::OrnCommentListItem(const QJsonObject &jsonObject, QObject *parent) :
+OrnCommentListItem::OrnCommentListItem(OrnJsonReader &reader, QObject *parent) :
     QObject(parent),
-    mCid(Orn::toUint(jsonObject[QStringLiteral("cid")])),
-    mPid(Orn::toUint(jsonObject[QStringLiteral("pid")])),
-    mCreated(Orn::toUint(jsonObject[QStringLiteral("created")])),
-    mText(Orn::toString(jsonObject[QStringLiteral("text")])),
-    mDate(OrnCommentListItem::sinceCreated(mCreated)),
+    mCid(0),
+    mPid(0),
+    mCreated(0),
+    mUserId(0),
     mCreatedTimer(new QTimer(this))
 {
-    auto user = jsonObject[QStringLiteral("user")].toObject();
-    mUserId = Orn::toUint(user[QStringLiteral("uid")]);
-    mUserName = Orn::toString(user[QStringLiteral("name")]);
-    mUserIconSource = Orn::toString(user[QStringLiteral("picture")].toObject()[QStringLiteral("url")]);
+    typedef OrnJsonField<OrnCommentListItem> Field;
+    static const Field pictureFields[] = {
+        { "url", [](OrnJsonReader &r, OrnCommentListItem &i) { i.mUserIconSource = r.readString(); } }
+    };
+    static const Field userFields[] = {
+        { "uid",     [](OrnJsonReader &r, OrnCommentListItem &i) { i.mUserId = r.readUint(); } },
+        { "name",    [](OrnJsonReader &r, OrnCommentListItem &i) { i.mUserName = r.readString(); } },
+        { "picture", [](OrnJsonReader &r, OrnCommentListItem &i) { r.decode(i, pictureFields); } }
+    };
+    static const Field fields[] = {
+        { "cid",     [](OrnJsonReader &r, OrnCommentListItem &i) { i.mCid = r.readUint(); } },
+        { "pid",     [](OrnJsonReader &r, OrnCommentListItem &i) { i.mPid = r.readUint(); } },
+        { "created", [](OrnJsonReader &r, OrnCommentListItem &i) { i.mCreated = r.readUint(); } },
+        { "text",    [](OrnJsonReader &r, OrnCommentListItem &i) { i.mText = r.readString(); } },
+        { "user",    [](OrnJsonReader &r, OrnCommentListItem &i) { r.decode(i, userFields); } }
+    };
+
+    reader.decode(*this, fields);
+    mDate = OrnCommentListItem::sinceCreated(mCreated);
 
     mCreatedTimer->setSingleShot(false);
     connect(mCreatedTimer, &QTimer::timeout, [=]()
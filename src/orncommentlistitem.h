@@ -4,6 +4,7 @@
 #include <QObject>
 
 class QTimer;
+class OrnJsonReader;
 
 class OrnCommentListItem : public QObject
 {
@@ -20,7 +21,7 @@ class OrnCommentListItem : public QObject
 
 public:
     explicit OrnCommentListItem(QObject *parent = nullptr);
-    OrnCommentListItem(const QJsonObject &jsonObject, QObject *parent = nullptr);
+    OrnCommentListItem(OrnJsonReader &reader, QObject *parent = nullptr);
 
 private:
     static QString sinceCreated(const quint64 &created);
@@ -1,7 +1,6 @@
 #include "orncommentsmodel.h"
 #include "ornapirequest.h"
 #include "orncommentlistitem.h"
-#include "orn.h"
 
 #include <QNetworkReply>
 #include <QDebug>
@@ -11,15 +10,7 @@ extern QNetworkAccessManager *ornNetworkAccessManager;
 OrnCommentsModel::OrnCommentsModel(QObject *parent) :
     OrnAbstractListModel(false, parent)
 {
-    connect(this, &OrnCommentsModel::rowsInserted, [=](const QModelIndex &parent, int first, int last)
-    {
-        Q_UNUSED(parent)
-        for (auto i = first; i < last; ++i)
-        {
-            auto comment = static_cast<OrnCommentListItem *>(mData[i]);
-            mCommentsMap.insert(comment->mCid, comment);
-        }
-    });
+    mApiRequest->setItemDecoder(&OrnAbstractListModel::decodeItem<OrnCommentListItem>);
 }
 
 quint32 OrnCommentsModel::appId() const
@@ -39,7 +30,9 @@ void OrnCommentsModel::setAppId(const quint32 &appId)
 
 OrnCommentListItem *OrnCommentsModel::findItem(const quint32 &cid) const
 {
-    return mCommentsMap.contains(cid) ? mCommentsMap[cid] : 0;
+    // Search the rows, as revalidated pages replace and remove the items
+    auto row = this->findItemRow(cid);
+    return row == -1 ? nullptr : static_cast<OrnCommentListItem *>(mData[row]);
 }
 
 int OrnCommentsModel::findItemRow(const quint32 &cid) const
@@ -61,13 +54,20 @@ void OrnCommentsModel::addComment(const quint32 &cid)
     auto reply = this->fetchComment(cid);
     connect(reply, &QNetworkReply::finished, [=]()
     {
-        auto jsonObject = this->processReply(reply);
-        if (jsonObject.isEmpty())
+        auto json = this->processReply(reply);
+        if (json.isEmpty())
         {
             return;
         }
+        OrnJsonReader reader(json);
+        auto comment = new OrnCommentListItem(reader, this);
+        if (reader.hasError())
+        {
+            delete comment;
+            return;
+        }
         this->beginInsertRows(QModelIndex(), 0, 0);
-        mData.prepend(new OrnCommentListItem(jsonObject, this));
+        mData.prepend(comment);
         this->endInsertRows();
     });
 }
@@ -77,19 +77,35 @@ void OrnCommentsModel::editComment(const quint32 &cid)
     auto reply = this->fetchComment(cid);
     connect(reply, &QNetworkReply::finished, [=]()
     {
-        auto jsonObject = this->processReply(reply);
-        if (jsonObject.isEmpty())
+        auto json = this->processReply(reply);
+        if (json.isEmpty())
         {
             return;
         }
-        auto cid = Orn::toUint(jsonObject[QStringLiteral("cid")]);
+
+        struct Comment
+        {
+            quint32 cid;
+            QString text;
+        } edited = { 0, QString() };
+        static const OrnJsonField<Comment> fields[] = {
+            { "cid",  [](OrnJsonReader &r, Comment &c) { c.cid = r.readUint(); } },
+            { "text", [](OrnJsonReader &r, Comment &c) { c.text = r.readString(); } }
+        };
+        OrnJsonReader reader(json);
+        if (!reader.decode(edited, fields))
+        {
+            return;
+        }
+
+        auto cid = edited.cid;
         auto size = mData.size();
         for (int i = 0; i < size; ++i)
         {
             auto comment = static_cast<OrnCommentListItem *>(mData[i]);
             if (comment->mCid == cid)
             {
-                comment->mText = Orn::toString(jsonObject[QStringLiteral("text")]);
+                comment->mText = edited.text;
                 auto index = this->createIndex(i, 0);
                 emit this->dataChanged(index, index);
                 return;
@@ -109,29 +125,17 @@ QNetworkReply *OrnCommentsModel::fetchComment(const quint32 &cid)
     return ornNetworkAccessManager->get(request);
 }
 
-QJsonObject OrnCommentsModel::processReply(QNetworkReply *reply)
+QByteArray OrnCommentsModel::processReply(QNetworkReply *reply)
 {
     // FIXME: need refactoring
+    reply->deleteLater();
     if (reply->error() != QNetworkReply::NoError)
     {
         qDebug() << "Network request error" << reply->error()
                  << "-" << reply->errorString();
-        reply->deleteLater();
-        return QJsonObject();
-    }
-
-    QJsonParseError error;
-    auto jsonDoc = QJsonDocument::fromJson(reply->readAll(), &error);
-    if (error.error == QJsonParseError::NoError)
-    {
-        return jsonDoc.object();
+        return QByteArray();
     }
-    else
-    {
-        qCritical() << "Could not parse reply:" << error.errorString();
-    }
-    reply->deleteLater();
-    return QJsonObject();
+    return reply->readAll();
 }
 
 QVariant OrnCommentsModel::data(const QModelIndex &index, int role) const
@@ -177,8 +181,8 @@ QHash<int, QByteArray> OrnCommentsModel::roleNames() const
 //    return true;
 //}
 
-void OrnCommentsModel::onJsonReady(const QJsonDocument &jsonDoc)
+void OrnCommentsModel::onJsonReady(const QByteArray &json)
 {
-    OrnAbstractListModel::processReply<OrnCommentListItem>(jsonDoc);
+    OrnAbstractListModel::processReply<OrnCommentListItem>(json);
 }
 
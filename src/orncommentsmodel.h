@@ -29,11 +29,10 @@ signals:
 
 private:
     QNetworkReply *fetchComment(const quint32 &cid);
-    QJsonObject processReply(QNetworkReply *reply);
+    QByteArray processReply(QNetworkReply *reply);
 
 private:
     quint32 mAppId;
-    QMap<quint32, OrnCommentListItem *> mCommentsMap;
 
     // QAbstractItemModel interface
 public:
@@ -44,7 +43,7 @@ public:
 
     // OrnAbstractListModel interface
 protected slots:
-    void onJsonReady(const QJsonDocument &jsonDoc);
+    void onJsonReady(const QByteArray &json);
 };
 
 #endif // ORNCOMMENTSMODEL_H
@@ -0,0 +1,23 @@
+#ifndef ORNINSTALLPREVIEW_H
+#define ORNINSTALLPREVIEW_H
+
+
+#include <QMetaType>
+#include <QStringList>
+
+struct OrnInstallPreview
+{
+    quint64 downloadSize;
+    quint64 installSize;
+    QString packageId;
+    /// Ids of all the packages to be installed including the dependencies
+    QStringList install;
+    /// Ids of the installed packages to be removed or replaced
+    QStringList remove;
+    /// Human readable descriptions of the solver problems
+    QStringList problems;
+};
+
+Q_DECLARE_METATYPE(OrnInstallPreview)
+
+#endif // ORNINSTALLPREVIEW_H
@@ -0,0 +1,156 @@
+#include "ornjsonarrayreader.h"
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+OrnJsonArrayReader::OrnJsonArrayReader()
+    : mState(StartState)
+    , mInElement(false)
+    , mInString(false)
+    , mEscape(false)
+    , mNeedComma(false)
+    , mDepth(0)
+{
+
+}
+
+QString OrnJsonArrayReader::errorString() const
+{
+    switch (mState)
+    {
+    case StartState:
+        return QStringLiteral("no data");
+    case ArrayState:
+        return QStringLiteral("unterminated array");
+    case NotArrayState:
+        return QStringLiteral("not an array");
+    case InvalidState:
+        return mErrorString;
+    default:
+        return QString();
+    }
+}
+
+QByteArrayList OrnJsonArrayReader::read(const QByteArray &chunk)
+{
+    QByteArrayList items;
+    auto p = chunk.constData();
+    auto end = p + chunk.size();
+    // The start of the current element in the chunk
+    auto begin = p;
+
+    while (p < end && mState != InvalidState && mState != NotArrayState)
+    {
+        auto c = *p;
+
+        if (mInElement)
+        {
+            if (mInString)
+            {
+                if (mEscape)
+                {
+                    mEscape = false;
+                }
+                else if (c == '\\')
+                {
+                    mEscape = true;
+                }
+                else if (c == '"')
+                {
+                    mInString = false;
+                    if (mDepth == 0)
+                    {
+                        // A string element
+                        mElement.append(begin, ++p - begin);
+                        this->finishElement(items);
+                        continue;
+                    }
+                }
+            }
+            else if (c == '"')
+            {
+                mInString = true;
+            }
+            else if (c == '{' || c == '[')
+            {
+                ++mDepth;
+            }
+            else if ((c == '}' || c == ']') && mDepth > 0)
+            {
+                if (--mDepth == 0)
+                {
+                    mElement.append(begin, ++p - begin);
+                    this->finishElement(items);
+                    continue;
+                }
+            }
+            else if (mDepth == 0 && (c == ',' || c == ']' || c == '}' || isSpace(c)))
+            {
+                // The end of a number or a literal,
+                // the delimiter is handled as a part of the array
+                mElement.append(begin, p - begin);
+                this->finishElement(items);
+                continue;
+            }
+            ++p;
+            continue;
+        }
+
+        if (isSpace(c))
+        {
+            ++p;
+            continue;
+        }
+
+        switch (mState)
+        {
+        case StartState:
+            mState = c == '[' ? ArrayState : NotArrayState;
+            break;
+        case ArrayState:
+            if (c == ']')
+            {
+                mState = EndState;
+            }
+            else if (c == ',' && mNeedComma)
+            {
+                mNeedComma = false;
+            }
+            else if (c == ',' || c == '}' || mNeedComma)
+            {
+                mState = InvalidState;
+                mErrorString = QStringLiteral("unexpected character in array");
+            }
+            else
+            {
+                // Read the first character again as a part of the element
+                mInElement = true;
+                mDepth = 0;
+                begin = p;
+                continue;
+            }
+            break;
+        default:
+            mState = InvalidState;
+            mErrorString = QStringLiteral("garbage at the end of the document");
+            break;
+        }
+        ++p;
+    }
+
+    if (mInElement)
+    {
+        mElement.append(begin, end - begin);
+    }
+    return items;
+}
+
+void OrnJsonArrayReader::finishElement(QByteArrayList &items)
+{
+    mInElement = false;
+    mNeedComma = true;
+    items << mElement;
+    mElement.clear();
+}
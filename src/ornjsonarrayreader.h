@@ -0,0 +1,58 @@
+#ifndef ORNJSONARRAYREADER_H
+#define ORNJSONARRAYREADER_H
+
+#include <QByteArrayList>
+#include <QString>
+
+/**
+ * @brief An incremental splitter of a top level JSON array
+ * The data is fed in chunks as it arrives and every element is returned
+ * as soon as its last byte is read, so the first elements are available
+ * long before the whole array is downloaded. Only the element boundaries
+ * are tracked here, the elements themselves are decoded by OrnJsonReader.
+ */
+class OrnJsonArrayReader
+{
+public:
+    enum State
+    {
+        /// Nothing but whitespace has been read
+        StartState,
+        /// Inside of the top level array
+        ArrayState,
+        /// The array has been closed
+        EndState,
+        /// The top level value is not an array
+        NotArrayState,
+        /// The array is malformed
+        InvalidState
+    };
+
+    OrnJsonArrayReader();
+
+    inline State state() const
+    { return mState; }
+
+    inline bool isArray() const
+    { return mState == ArrayState || mState == EndState; }
+
+    QString errorString() const;
+
+    /// Read the next chunk of data and return the raw completed elements
+    QByteArrayList read(const QByteArray &chunk);
+
+private:
+    void finishElement(QByteArrayList &items);
+
+    State mState;
+    bool mInElement;
+    bool mInString;
+    bool mEscape;
+    bool mNeedComma;
+    int mDepth;
+    // The bytes of the current element
+    QByteArray mElement;
+    QString mErrorString;
+};
+
+#endif // ORNJSONARRAYREADER_H
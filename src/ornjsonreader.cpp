@@ -0,0 +1,357 @@
+#include "ornjsonreader.h"
+
+#include <QDebug>
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static QString unescape(const char *begin, const char *end)
+{
+    QString res;
+    res.reserve(int(end - begin));
+    auto chunk = begin;
+    for (auto p = begin; p < end; ++p)
+    {
+        if (*p != '\\')
+        {
+            continue;
+        }
+        // Escape sequences are ASCII, so UTF-8 sequences are never split
+        res.append(QString::fromUtf8(chunk, int(p - chunk)));
+        if (++p == end)
+        {
+            return res;
+        }
+        switch (*p)
+        {
+        case 'b':
+            res.append(QChar('\b'));
+            break;
+        case 'f':
+            res.append(QChar('\f'));
+            break;
+        case 'n':
+            res.append(QChar('\n'));
+            break;
+        case 'r':
+            res.append(QChar('\r'));
+            break;
+        case 't':
+            res.append(QChar('\t'));
+            break;
+        case 'u':
+        {
+            // Surrogate pairs come as two escapes of UTF-16 units
+            ushort unit = 0;
+            for (int i = 0; i < 4 && p + 1 < end; ++i)
+            {
+                auto value = hexValue(*(p + 1));
+                if (value < 0)
+                {
+                    break;
+                }
+                unit = (unit << 4) | ushort(value);
+                ++p;
+            }
+            res.append(QChar(unit));
+            break;
+        }
+        default:
+            res.append(QLatin1Char(*p));
+            break;
+        }
+        chunk = p + 1;
+    }
+    res.append(QString::fromUtf8(chunk, int(end - chunk)));
+    return res;
+}
+
+OrnJsonReader::OrnJsonReader(const QByteArray &data)
+    : mData(data)
+    , mPos(mData.constData())
+    , mEnd(mPos + mData.size())
+    , mError(false)
+{
+
+}
+
+char OrnJsonReader::peek()
+{
+    while (mPos < mEnd && isSpace(*mPos))
+    {
+        ++mPos;
+    }
+    return mPos < mEnd ? *mPos : '\0';
+}
+
+void OrnJsonReader::setError()
+{
+    if (!mError)
+    {
+        qWarning() << "Could not read JSON at position" << (mPos - mData.constData());
+        mError = true;
+    }
+    // Stop reading
+    mPos = mEnd;
+}
+
+bool OrnJsonReader::beginObject()
+{
+    if (this->peek() == '{')
+    {
+        ++mPos;
+        return true;
+    }
+    this->skip();
+    return false;
+}
+
+bool OrnJsonReader::nextKey(QLatin1String &key)
+{
+    if (mError)
+    {
+        return false;
+    }
+    auto c = this->peek();
+    if (c == ',')
+    {
+        ++mPos;
+        c = this->peek();
+    }
+    if (c == '}')
+    {
+        ++mPos;
+        return false;
+    }
+
+    const char *begin;
+    const char *end;
+    bool escaped;
+    // The API keys are never escaped
+    if (c != '"' || !this->readStringBounds(begin, end, escaped) || this->peek() != ':')
+    {
+        this->setError();
+        return false;
+    }
+    ++mPos;
+    key = QLatin1String(begin, int(end - begin));
+    return true;
+}
+
+bool OrnJsonReader::beginArray()
+{
+    if (this->peek() == '[')
+    {
+        ++mPos;
+        return true;
+    }
+    this->skip();
+    return false;
+}
+
+bool OrnJsonReader::nextElement()
+{
+    if (mError)
+    {
+        return false;
+    }
+    auto c = this->peek();
+    if (c == ',')
+    {
+        ++mPos;
+        c = this->peek();
+    }
+    if (c == ']')
+    {
+        ++mPos;
+        return false;
+    }
+    if (c == '\0')
+    {
+        this->setError();
+        return false;
+    }
+    return true;
+}
+
+bool OrnJsonReader::readStringBounds(const char *&begin, const char *&end, bool &escaped)
+{
+    // Skip the opening quote
+    begin = ++mPos;
+    escaped = false;
+    while (mPos < mEnd)
+    {
+        if (*mPos == '\\')
+        {
+            escaped = true;
+            mPos += 2;
+        }
+        else if (*mPos == '"')
+        {
+            end = mPos++;
+            return true;
+        }
+        else
+        {
+            ++mPos;
+        }
+    }
+    this->setError();
+    return false;
+}
+
+bool OrnJsonReader::readScalarBounds(const char *&begin, const char *&end)
+{
+    auto c = this->peek();
+    if (c == '"')
+    {
+        bool escaped;
+        return this->readStringBounds(begin, end, escaped);
+    }
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        begin = mPos;
+        this->skip();
+        end = mPos;
+        return true;
+    }
+    this->skip();
+    return false;
+}
+
+quint32 OrnJsonReader::readUint()
+{
+    const char *begin;
+    const char *end;
+    if (!this->readScalarBounds(begin, end))
+    {
+        return 0;
+    }
+    quint32 value = 0;
+    for (auto p = begin; p < end; ++p)
+    {
+        auto c = *p;
+        if (c >= '0' && c <= '9')
+        {
+            value = value * 10 + quint32(c - '0');
+        }
+        else if (c != ',' && !isSpace(c))
+        {
+            return 0;
+        }
+    }
+    return value;
+}
+
+float OrnJsonReader::readFloat()
+{
+    const char *begin;
+    const char *end;
+    if (!this->readScalarBounds(begin, end))
+    {
+        return 0.0;
+    }
+    return QByteArray::fromRawData(begin, int(end - begin)).trimmed().toFloat();
+}
+
+QString OrnJsonReader::readString()
+{
+    auto c = this->peek();
+    if (c == '"')
+    {
+        const char *begin;
+        const char *end;
+        bool escaped;
+        if (!this->readStringBounds(begin, end, escaped))
+        {
+            return QString();
+        }
+        if (escaped)
+        {
+            return unescape(begin, end).trimmed();
+        }
+        while (begin < end && isSpace(*begin))
+        {
+            ++begin;
+        }
+        while (end > begin && isSpace(*(end - 1)))
+        {
+            --end;
+        }
+        return QString::fromUtf8(begin, int(end - begin));
+    }
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        auto begin = mPos;
+        this->skip();
+        return QString::fromLatin1(begin, int(mPos - begin));
+    }
+    this->skip();
+    return QString();
+}
+
+void OrnJsonReader::skip()
+{
+    auto c = this->peek();
+    switch (c)
+    {
+    case '"':
+    {
+        const char *begin;
+        const char *end;
+        bool escaped;
+        this->readStringBounds(begin, end, escaped);
+        return;
+    }
+    case '{':
+    {
+        ++mPos;
+        QLatin1String key;
+        while (this->nextKey(key))
+        {
+            this->skip();
+        }
+        return;
+    }
+    case '[':
+        ++mPos;
+        while (this->nextElement())
+        {
+            this->skip();
+        }
+        return;
+    default:
+    {
+        // A number or a literal
+        auto begin = mPos;
+        while (mPos < mEnd && *mPos != ',' && *mPos != '}' && *mPos != ']' && !isSpace(*mPos))
+        {
+            ++mPos;
+        }
+        if (mPos == begin)
+        {
+            this->setError();
+        }
+        return;
+    }
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef ORNJSONREADER_H
+#define ORNJSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <cstddef>
+
+class OrnJsonReader;
+
+/**
+ * @brief A field of a JSON object schema
+ * The read function consumes the value of the key and stores it in the target.
+ * Non-capturing lambdas defined in a member function can be used as read
+ * functions to access private members.
+ */
+template<typename T>
+struct OrnJsonField
+{
+    const char *key;
+    void (*read)(OrnJsonReader &reader, T &target);
+};
+
+/**
+ * @brief A pull reader of OpenRepos API replies
+ * The values are read straight from the raw bytes in one pass without
+ * building a JSON DOM. Objects are decoded with a static table of
+ * OrnJsonField per type, the keys missing in the table are skipped.
+ * A value of an unexpected type is skipped and read as an empty one,
+ * as the API sends numbers as strings and empty objects as arrays.
+ */
+class OrnJsonReader
+{
+public:
+    explicit OrnJsonReader(const QByteArray &data);
+
+    inline bool hasError() const
+    { return mError; }
+
+    /// Enter an object, a value of another type is skipped
+    bool beginObject();
+    /// Read the next key of the current object, returns false at the end of the object
+    bool nextKey(QLatin1String &key);
+    /// Enter an array, a value of another type is skipped
+    bool beginArray();
+    /// Move to the next element of the current array, returns false at the end of the array
+    bool nextElement();
+
+    /// Read a number or a numeric string with thousands separators
+    quint32 readUint();
+    float readFloat();
+    /// Read a trimmed string, numbers are read as text
+    QString readString();
+    void skip();
+
+    /// Decode the next object into the target with the schema fields
+    template<typename T, std::size_t N>
+    bool decode(T &target, const OrnJsonField<T> (&fields)[N])
+    {
+        if (!this->beginObject())
+        {
+            return false;
+        }
+        QLatin1String key;
+        while (this->nextKey(key))
+        {
+            std::size_t i = 0;
+            while (i < N && key != QLatin1String(fields[i].key))
+            {
+                ++i;
+            }
+            if (i < N)
+            {
+                fields[i].read(*this, target);
+            }
+            else
+            {
+                this->skip();
+            }
+        }
+        return !mError;
+    }
+
+private:
+    char peek();
+    void setError();
+    bool readStringBounds(const char *&begin, const char *&end, bool &escaped);
+    bool readScalarBounds(const char *&begin, const char *&end);
+
+    QByteArray mData;
+    const char *mPos;
+    const char *mEnd;
+    bool mError;
+};
+
+#endif // ORNJSONREADER_H
@@ -0,0 +1,105 @@
+#include "ornnetworkcache.h"
+
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QRegularExpression>
+
+#include <QDebug>
+
+#define CACHE_MAX_SIZE (20 * 1024 * 1024)
+#define API_PATH_PREFIX "/api/v1/"
+
+#define MINUTE 60
+#define HOUR   (60 * MINUTE)
+#define DAY    (24 * HOUR)
+
+struct FreshnessPolicy
+{
+    QRegularExpression resource;
+    qint64 seconds;
+};
+
+// The first matching policy is used
+static const QList<FreshnessPolicy> freshnessPolicies{
+    // Authorisation must always reach the server
+    { QRegularExpression(QStringLiteral("^(session|user/)")),  0 },
+    { QRegularExpression(QStringLiteral("^categories$")),      DAY },
+    { QRegularExpression(QStringLiteral("^apps/\\d+$")),       10 * MINUTE },
+    { QRegularExpression(QStringLiteral("comments")),          MINUTE },
+    { QRegularExpression(QStringLiteral("^search/")),          5 * MINUTE },
+    { QRegularExpression(QStringLiteral(".")),                 5 * MINUTE }
+};
+
+OrnNetworkCache::OrnNetworkCache(const QByteArray &language, QObject *parent)
+    : QNetworkDiskCache(parent)
+{
+    auto dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            .append(QStringLiteral("/network/"))
+            .append(QString::fromUtf8(language));
+    this->setCacheDirectory(dir);
+    this->setMaximumCacheSize(CACHE_MAX_SIZE);
+    qDebug() << "Using network cache in" << dir;
+}
+
+qint64 OrnNetworkCache::freshness(const QUrl &url)
+{
+    auto path = url.path();
+    if (!path.startsWith(QLatin1String(API_PATH_PREFIX)))
+    {
+        return 0;
+    }
+    path.remove(0, int(sizeof(API_PATH_PREFIX)) - 1);
+    for (const auto &policy : freshnessPolicies)
+    {
+        if (policy.resource.match(path).hasMatch())
+        {
+            return policy.seconds;
+        }
+    }
+    return 0;
+}
+
+QIODevice *OrnNetworkCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    if (OrnNetworkCache::freshness(metaData.url()) == 0)
+    {
+        return nullptr;
+    }
+    return QNetworkDiskCache::prepare(OrnNetworkCache::withFreshness(metaData));
+}
+
+void OrnNetworkCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+    // Called after a successful revalidation
+    QNetworkDiskCache::updateMetaData(OrnNetworkCache::withFreshness(metaData));
+}
+
+QNetworkCacheMetaData OrnNetworkCache::withFreshness(const QNetworkCacheMetaData &metaData)
+{
+    auto seconds = OrnNetworkCache::freshness(metaData.url());
+    if (seconds == 0)
+    {
+        return metaData;
+    }
+
+    // The API does not send caching headers, so use our own freshness
+    // but keep the validators to revalidate the stale replies
+    QNetworkCacheMetaData md(metaData);
+    md.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(seconds));
+    md.setSaveToDisk(true);
+    auto headers = md.rawHeaders();
+    for (auto it = headers.begin(); it != headers.end();)
+    {
+        auto name = it->first.toLower();
+        if (name == "cache-control" || name == "pragma" || name == "expires")
+        {
+            it = headers.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    md.setRawHeaders(headers);
+    return md;
+}
@@ -0,0 +1,30 @@
+#ifndef ORNNETWORKCACHE_H
+#define ORNNETWORKCACHE_H
+
+#include <QNetworkDiskCache>
+
+/**
+ * @brief The disk cache of the OpenRepos API replies
+ * Every API resource gets its own freshness period, fresh replies are
+ * served without network and stale ones are revalidated with ETag and
+ * Last-Modified. The cache dir depends on the Accept-Language value,
+ * so the replies in different languages never mix.
+ */
+class OrnNetworkCache : public QNetworkDiskCache
+{
+    Q_OBJECT
+
+public:
+    OrnNetworkCache(const QByteArray &language, QObject *parent = nullptr);
+
+    /// The freshness period of the API resource in seconds
+    static qint64 freshness(const QUrl &url);
+
+    QIODevice *prepare(const QNetworkCacheMetaData &metaData);
+    void updateMetaData(const QNetworkCacheMetaData &metaData);
+
+private:
+    static QNetworkCacheMetaData withFreshness(const QNetworkCacheMetaData &metaData);
+};
+
+#endif // ORNNETWORKCACHE_H
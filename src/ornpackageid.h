@@ -0,0 +1,70 @@
+#ifndef ORNPACKAGEID_H
+#define ORNPACKAGEID_H
+
+#include <QString>
+#include <QStringRef>
+
+/**
+ * @brief A parsed PackageKit package id "name;version;arch;repo"
+ * The id is split once and the fields are returned as views into it
+ * without allocations. The views are valid while the object exists.
+ */
+class OrnPackageId
+{
+public:
+    explicit OrnPackageId(const QString &id = QString())
+        : mId(id)
+    {
+        QChar sep(';');
+        mSeps[0] = mId.indexOf(sep);
+        mSeps[1] = mSeps[0] < 0 ? -1 : mId.indexOf(sep, mSeps[0] + 1);
+        mSeps[2] = mSeps[1] < 0 ? -1 : mId.indexOf(sep, mSeps[1] + 1);
+    }
+
+    inline bool isValid() const
+    { return mSeps[2] > 0; }
+
+    inline const QString &toString() const
+    { return mId; }
+
+    inline QStringRef name() const
+    { return this->field(0); }
+
+    inline QStringRef version() const
+    { return this->field(1); }
+
+    inline QStringRef arch() const
+    { return this->field(2); }
+
+    inline QStringRef repo() const
+    { return this->field(3); }
+
+    static QString join(const QString &name, const QString &version,
+                        const QString &arch, const QString &repo)
+    {
+        QString id;
+        QChar sep(';');
+        id.reserve(name.size() + version.size() + arch.size() + repo.size() + 3);
+        id.append(name).append(sep).append(version).append(sep)
+          .append(arch).append(sep).append(repo);
+        return id;
+    }
+
+private:
+    QStringRef field(int i) const
+    {
+        if (i > 0 && mSeps[i - 1] < 0)
+        {
+            return QStringRef();
+        }
+        auto start = i == 0 ? 0 : mSeps[i - 1] + 1;
+        auto end = i < 3 && mSeps[i] >= 0 ? mSeps[i] : mId.size();
+        return QStringRef(&mId, start, end - start);
+    }
+
+    QString mId;
+    // Positions of the separators
+    int mSeps[3];
+};
+
+#endif // ORNPACKAGEID_H
@@ -0,0 +1,205 @@
+#include "ornpackageindex.h"
+#include "ornpm.h"
+
+#include <solv/repo_solv.h>
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <QDebug>
+
+OrnPackageIndex::OrnPackageIndex(const QString &cacheDir)
+    : mCacheDir(cacheDir)
+{}
+
+bool OrnPackageIndex::update(const QSet<QString> &archs)
+{
+    QDir dir(mCacheDir);
+    QString prefix(OrnPm::repoNamePrefix);
+    auto aliases = dir.entryList({ prefix + QChar('*') }, QDir::Dirs | QDir::NoDotAndDotDot);
+    bool changed = false;
+
+    QWriteLocker locker(&mLock);
+
+    // Drop the repositories which caches were removed
+    for (const auto &alias : mRepoTimes.keys())
+    {
+        if (!aliases.contains(alias))
+        {
+            qDebug() << "Removing repo" << alias << "from the package index";
+            this->removeRepo(alias);
+            changed = true;
+        }
+    }
+
+    for (const auto &alias : aliases)
+    {
+        QFileInfo info(dir.absoluteFilePath(alias + QStringLiteral("/solv")));
+        if (!info.isFile())
+        {
+            continue;
+        }
+        auto modified = info.lastModified();
+        if (mRepoTimes.value(alias) == modified)
+        {
+            continue;
+        }
+        auto indexed = mRepoTimes.contains(alias);
+        this->removeRepo(alias);
+        // A repo which could not be read is retried on the next update
+        if (this->addRepo(alias, info.absoluteFilePath(), archs))
+        {
+            mRepoTimes.insert(alias, modified);
+            changed = true;
+        }
+        else if (indexed)
+        {
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        qDebug() << "Package index has" << mPackages.size() << "packages from"
+                 << mRepoTimes.size() << "repositories";
+    }
+    return changed;
+}
+
+void OrnPackageIndex::clear()
+{
+    QWriteLocker locker(&mLock);
+    mPackages.clear();
+    mRepoTimes.clear();
+    mRepoPackages.clear();
+}
+
+OrnPackageVersionList OrnPackageIndex::find(const QString &name) const
+{
+    QReadLocker locker(&mLock);
+    return mPackages.value(name);
+}
+
+OrnPackageVersionMap OrnPackageIndex::findPrefix(const QString &prefix) const
+{
+    QReadLocker locker(&mLock);
+    OrnPackageVersionMap res;
+    for (auto it = mPackages.lowerBound(prefix);
+         it != mPackages.cend() && it.key().startsWith(prefix); ++it)
+    {
+        res.insert(it.key(), it.value());
+    }
+    return res;
+}
+
+OrnPackageVersionMap OrnPackageIndex::packages(const QSet<QString> &aliases) const
+{
+    QReadLocker locker(&mLock);
+    OrnPackageVersionMap res;
+    for (auto it = mPackages.cbegin(); it != mPackages.cend(); ++it)
+    {
+        OrnPackageVersionList versions;
+        for (const auto &version : it.value())
+        {
+            if (aliases.contains(version.repoAlias))
+            {
+                versions << version;
+            }
+        }
+        if (!versions.isEmpty())
+        {
+            // Insertion in order is amortized constant
+            res.insert(res.cend(), it.key(), versions);
+        }
+    }
+    return res;
+}
+
+QStringList OrnPackageIndex::repoAliases() const
+{
+    QReadLocker locker(&mLock);
+    return mRepoTimes.keys();
+}
+
+void OrnPackageIndex::removeRepo(const QString &alias)
+{
+    mRepoTimes.remove(alias);
+    for (const auto &name : mRepoPackages.take(alias))
+    {
+        auto it = mPackages.find(name);
+        if (it == mPackages.end())
+        {
+            continue;
+        }
+        auto &versions = it.value();
+        for (int i = versions.size() - 1; i >= 0; --i)
+        {
+            if (versions[i].repoAlias == alias)
+            {
+                versions.removeAt(i);
+            }
+        }
+        if (versions.isEmpty())
+        {
+            mPackages.erase(it);
+        }
+    }
+}
+
+bool OrnPackageIndex::addRepo(const QString &alias, const QString &path, const QSet<QString> &archs)
+{
+    qDebug() << "Indexing" << path;
+    auto sfile = fopen(path.toUtf8().data(), "r");
+    if (!sfile)
+    {
+        qCritical() << "Could not read" << path;
+        return false;
+    }
+
+    auto spool = pool_create();
+    auto srepo = repo_create(spool, alias.toUtf8().data());
+    auto res = repo_add_solv(srepo, sfile, 0);
+    fclose(sfile);
+    if (res != 0)
+    {
+        qCritical() << "Could not read" << path << "-" << pool_errstr(spool);
+        pool_free(spool);
+        return false;
+    }
+
+    QSet<QString> names;
+    for (int i = 2; i < spool->nsolvables; ++i)
+    {
+        auto s = &spool->solvables[i];
+        if (!s->repo)
+        {
+            continue;
+        }
+        QString arch(pool_id2str(spool, s->arch));
+        if (!archs.contains(arch))
+        {
+            continue;
+        }
+        QString name(pool_id2str(spool, s->name));
+        auto &versions = mPackages[name];
+        versions << OrnPackageVersion(
+                        solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0),
+                        solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0),
+                        pool_id2str(spool, s->evr),
+                        arch,
+                        alias);
+        names.insert(name);
+    }
+
+    repo_free(srepo, 0);
+    pool_free(spool);
+
+    for (const auto &name : names)
+    {
+        auto &versions = mPackages[name];
+        std::sort(versions.rbegin(), versions.rend());
+    }
+
+    mRepoPackages.insert(alias, names.toList());
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef ORNPACKAGEINDEX_H
+#define ORNPACKAGEINDEX_H
+
+#include "ornpackageversion.h"
+
+#include <QSet>
+#include <QDateTime>
+#include <QReadWriteLock>
+
+/**
+ * @brief An index of the packages from all the ORN solv caches on disk
+ * It includes the disabled repositories too. Only the changed solv files
+ * are reread on update. The class is thread safe.
+ */
+class OrnPackageIndex
+{
+public:
+    explicit OrnPackageIndex(const QString &cacheDir);
+
+    bool update(const QSet<QString> &archs);
+    void clear();
+
+    OrnPackageVersionList find(const QString &name) const;
+    OrnPackageVersionMap findPrefix(const QString &prefix) const;
+    OrnPackageVersionMap packages(const QSet<QString> &aliases) const;
+    QStringList repoAliases() const;
+
+private:
+    void removeRepo(const QString &alias);
+    // Returns false if the solv file could not be read
+    bool addRepo(const QString &alias, const QString &path, const QSet<QString> &archs);
+
+    QString mCacheDir;
+    mutable QReadWriteLock mLock;
+    OrnPackageVersionMap mPackages;
+    // <alias, solv file modification time>
+    QHash<QString, QDateTime> mRepoTimes;
+    // <alias, package names>
+    QHash<QString, QStringList> mRepoPackages;
+};
+
+#endif // ORNPACKAGEINDEX_H
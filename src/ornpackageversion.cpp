@@ -1,4 +1,5 @@
 #include "ornpackageversion.h"
+#include "ornpackageid.h"
 
 //#include <QVariantList>
 #include <QRegularExpression>
@@ -28,11 +29,7 @@ OrnPackageVersion::OrnPackageVersion(const quint64 &dsize, const quint64 &isize,
 
 QString OrnPackageVersion::packageId(const QString &name) const
 {
-    QString id(name);
-    QChar sep(';');
-    id.reserve(name.size() + version.size() + arch.size() + repoAlias.size() + 3);
-    id.append(sep).append(version).append(sep).append(arch).append(sep).append(repoAlias);
-    return id;
+    return OrnPackageId::join(name, version, arch, repoAlias);
 }
 
 bool OrnPackageVersion::operator ==(const OrnPackageVersion &other) const
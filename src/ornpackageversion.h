@@ -3,6 +3,7 @@
 
 
 #include <QVariantList>
+#include <QMap>
 
 struct OrnPackageVersion
 {
@@ -29,7 +30,10 @@ private:
 };
 
 typedef QList<OrnPackageVersion> OrnPackageVersionList;
+// <package name, versions>
+typedef QMap<QString, OrnPackageVersionList> OrnPackageVersionMap;
 
 Q_DECLARE_METATYPE(QList<OrnPackageVersion>)
+Q_DECLARE_METATYPE(OrnPackageVersionMap)
 
 #endif // ORNPACKAGEVERSION_H
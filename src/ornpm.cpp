@@ -1,12 +1,20 @@
 #include "ornpm_p.h"
 #include "ornpackageversion.h"
 #include "orninstalledpackage.h"
+#include "ornupdatablepackage.h"
+#include "orninstallpreview.h"
 #include "ornrepo.h"
 #include "orn.h"
+#include "ornpackageid.h"
 
 #include <solv/repo_solv.h>
+#include <solv/solver.h>
+#include <solv/transaction.h>
 
 #include <QtConcurrent/QtConcurrent>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusReply>
+#include <QtDBus/QDBusVariant>
 
 #include <QDebug>
 
@@ -35,16 +43,90 @@ OrnPm::OrnPm(QObject *parent)
 
 OrnPmPrivate::OrnPmPrivate(OrnPm *ornPm)
     : initialised(false)
+    , addedReposRefreshing(0)
+    , addedReposFinished(0)
+    , addedReposTotal(0)
+    , pool(nullptr)
+    , poolDirty(1)
+    , enablingRepos(false)
+    , reposGeneration(0)
+    , packageIndex(SOLV_CACHE_DIR)
     , q_ptr(ornPm)
 {
-    auto bus = QDBusConnection::systemBus();
+    auto bus = OrnPmPrivate::bus();
 
-    QString service(SSU_SERVICE);
-    ssuInterface = new QDBusInterface(service, SSU_PATH, service, bus, q_ptr);
-
-    service = PK_SERVICE;
-    pkInterface = new QDBusInterface(service, PK_PATH, service, bus, q_ptr);
+    // The service names can be overridden, the interface names are fixed
+    ssuInterface = new QDBusInterface(SSU_SERVICE, SSU_PATH, SSU_INTERFACE, bus, q_ptr);
+    pkInterface = new QDBusInterface(PK_SERVICE, PK_PATH, PK_INTERFACE, bus, q_ptr);
     QObject::connect(pkInterface, SIGNAL(UpdatesChanged()), q_ptr, SLOT(getUpdates()));
+
+    journal = new OrnTransactionJournal(QStandardPaths::writableLocation(
+                QStandardPaths::AppLocalDataLocation) + QStringLiteral("/transactions"), q_ptr);
+
+    sysInfo = new OrnSystemInfo(ssuInterface, q_ptr);
+    QObject::connect(sysInfo, &OrnSystemInfo::deviceModelChanged, q_ptr, &OrnPm::deviceModelChanged);
+    QObject::connect(sysInfo, &OrnSystemInfo::releaseChanged, q_ptr, &OrnPm::releaseChanged);
+    QObject::connect(sysInfo, &OrnSystemInfo::archChanged, [this]()
+    {
+        // Packages of other archs should be reread
+        this->invalidatePool();
+        packageIndex.clear();
+    });
+    QObject::connect(sysInfo, &OrnSystemInfo::configChanged, [this]()
+    {
+        this->onSsuConfigChanged();
+    });
+    // The config is read in initialise()
+    sysInfo->requestDeviceModel();
+}
+
+QDBusConnection OrnPmPrivate::bus()
+{
+    auto name = ORN_PM_BUS;
+    if (name == QLatin1String("system"))
+    {
+        return QDBusConnection::systemBus();
+    }
+    if (name == QLatin1String("session"))
+    {
+        return QDBusConnection::sessionBus();
+    }
+    // A private bus address, the connection is shared by name
+    auto bus = QDBusConnection::connectToBus(name, QStringLiteral("ornpm"));
+    if (!bus.isConnected())
+    {
+        qCritical() << "Could not connect to" << name << "-" << bus.lastError().message();
+    }
+    return bus;
+}
+
+QString OrnPmPrivate::lastPackage(QObject *t)
+{
+    Q_ASSERT(t);
+    // QDBusInterface::property() needs the property in the introspection data,
+    // so the standard Properties interface is called explicitly
+    auto tr = static_cast<QDBusInterface *>(t);
+    auto message = QDBusMessage::createMethodCall(
+                tr->service(), tr->path(),
+                QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+    message << PK_TR_INTERFACE << QStringLiteral(PK_PROP_LASTPACKAGE);
+    QDBusReply<QDBusVariant> reply = tr->connection().call(message);
+    if (!reply.isValid())
+    {
+        qWarning() << "Could not read the last package of" << tr->path()
+                   << "-" << reply.error().message();
+        return QString();
+    }
+    return reply.value().variant().toString();
+}
+
+OrnPmPrivate::~OrnPmPrivate()
+{
+    QMutexLocker locker(&poolMutex);
+    if (pool)
+    {
+        pool_free(pool);
+    }
 }
 
 OrnPm::~OrnPm()
@@ -72,35 +154,20 @@ void OrnPmPrivate::initialise()
 {
     qDebug() << "Getting the list of ORN repositories";
 
-    // NOTE: A hack for SSU repos. Can break on ssu config changes.
-    QSettings ssuSettings(SSU_CONFIG_PATH, QSettings::IniFormat);
-
-    archs << ssuSettings.value(QStringLiteral("arch")).toString()
-          << QStringLiteral("noarch");
+    // Make sure the arch is known before any package is read
+    sysInfo->readConfig();
 
-    auto disabled = ssuSettings.value(SSU_DISABLED_KEY).toStringList().toSet();
-    ssuSettings.beginGroup(SSU_REPOS_GROUP);
-    auto aliases = ssuSettings.childKeys();
-
-    for (const auto &alias : aliases)
-    {
-        if (alias.startsWith(OrnPm::repoNamePrefix))
-        {
-            auto enabled = !disabled.contains(alias);
-            qDebug() << "Found" << (enabled ? "enabled" : "disabled") << "repo" << alias;
-            repos.insert(alias, enabled);
-        }
-    }
+    repos = OrnPmPrivate::readRepos();
     qDebug() << "System has" << repos.size() << "ORN repositories";
 
     qDebug() << "Getting the list of installed packages";
     auto spool = pool_create();
     auto srepo = repo_create(spool, "installed");
 
-    auto sfile = fopen(SOLV_INSTALLED, "r");
+    auto sfile = fopen(QFile::encodeName(SOLV_INSTALLED).constData(), "r");
     if (!sfile)
     {
-        qCritical() << "Could not read " SOLV_INSTALLED;
+        qCritical() << "Could not read" << SOLV_INSTALLED;
         repo_free(srepo, 0);
         pool_free(spool);
         return;
@@ -149,10 +216,17 @@ QVariantList OrnPm::operations() const
 
 QString OrnPm::deviceModel() const
 {
-    // Ssu::DeviceModel = 1
-    qDebug().nospace() << "Calling " << d_ptr->ssuInterface << "->" SSU_METHOD_DISPLAYNAME "(1)";
-    auto call = d_ptr->ssuInterface->call(QDBus::BlockWithGui, QStringLiteral(SSU_METHOD_DISPLAYNAME), 1);
-    return call.arguments().first().toString();
+    return d_ptr->sysInfo->deviceModel();
+}
+
+QString OrnPm::release() const
+{
+    return d_ptr->sysInfo->release();
+}
+
+OrnTransactionJournal *OrnPm::journal() const
+{
+    return d_ptr->journal;
 }
 
 bool OrnPm::updatesAvailable() const
@@ -205,7 +279,7 @@ OrnPm::PackageStatus OrnPm::packageStatus(const QString &packageName) const
     return PackageNotInstalled;
 }
 
-QDBusInterface *OrnPmPrivate::transaction()
+QDBusInterface *OrnPmPrivate::transaction(const char *kind, const QString &item)
 {
     auto reply = pkInterface->call(QStringLiteral("CreateTransaction"));
     Q_ASSERT_X(reply.type() != QDBusMessage::ErrorMessage, Q_FUNC_INFO,
@@ -214,28 +288,40 @@ QDBusInterface *OrnPmPrivate::transaction()
     auto t = new QDBusInterface(PK_SERVICE,
                                 qvariant_cast<QDBusObjectPath>(reply.arguments().first()).path(),
                                 PK_TR_INTERFACE,
-                                QDBusConnection::systemBus(),
+                                OrnPmPrivate::bus(),
                                 q_ptr);
     Q_ASSERT(t->isValid());
-#ifdef QT_DEBUG
+    journal->begin(t, QString::fromLatin1(kind), item);
     QObject::connect(t, SIGNAL(Finished(quint32,quint32)),  q_ptr, SLOT(onTransactionFinished(quint32,quint32)));
+#ifdef QT_DEBUG
     QObject::connect(t, SIGNAL(ErrorCode(quint32,QString)), q_ptr, SLOT(emitError(quint32,QString)));
 #else
-    QObject::connect(t, SIGNAL(Finished(quint32, quint32)), t, SLOT(deleteLater()));
     QObject::connect(t, SIGNAL(ErrorCode(quint32,QString)), q_ptr, SIGNAL(error(quint32,QString)));
 #endif
     return t;
 }
 
-#ifdef QT_DEBUG
 void OrnPm::onTransactionFinished(quint32 exit, quint32 runtime)
 {
-    qDebug() << this->sender()
-             << (exit == Transaction::ExitSuccess ? "finished in" : "failed after")
+    auto t = this->sender();
+#ifdef QT_DEBUG
+    qDebug() << t << (exit == Transaction::ExitSuccess ? "finished in" : "failed after")
              << runtime << "msec";
-    this->sender()->deleteLater();
+#else
+    Q_UNUSED(runtime)
+#endif
+    // Use the size of the repo metadata for refreshes
+    auto item = d_ptr->journal->item(t);
+    quint64 bytes = 0;
+    if (item.startsWith(OrnPm::repoNamePrefix))
+    {
+        bytes = QFileInfo(SOLV_PATH_TMPL.arg(item)).size();
+    }
+    d_ptr->journal->end(t, exit, bytes);
+    t->deleteLater();
 }
 
+#ifdef QT_DEBUG
 void OrnPm::emitError(quint32 code, QString details)
 {
     qDebug() << this->sender() << "error code" << code << "-" << details;
@@ -245,7 +331,7 @@ void OrnPm::emitError(quint32 code, QString details)
 
 void OrnPm::getUpdates()
 {
-    auto t = d_ptr->transaction();
+    auto t = d_ptr->transaction(PK_METHOD_GETUPDATES);
     connect(t, SIGNAL(Package(quint32,QString,QString)), this, SLOT(onPackageUpdate(quint32,QString,QString)));
     connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onGetUpdatesFinished(quint32,quint32)));
     qDebug().nospace() << "Calling " << t << "->" PK_METHOD_GETUPDATES "(" << PK_FLAG_NONE << ")";
@@ -257,9 +343,10 @@ void OrnPm::onPackageUpdate(quint32 info, QString packageId, QString summary)
     Q_UNUSED(summary)
     Q_ASSERT(info == Transaction::InfoEnhancement);
     // Filter updates only for ORN packages
-    if (Orn::packageRepo(packageId).startsWith(repoNamePrefix))
+    OrnPackageId id(packageId);
+    if (id.isValid() && id.repo().startsWith(repoNamePrefix))
     {
-        d_ptr->newUpdatablePackages.insert(Orn::packageName(packageId), packageId);
+        d_ptr->newUpdatablePackages.insert(id.name().toString(), packageId);
     }
 }
 
@@ -281,6 +368,16 @@ void OrnPm::onGetUpdatesFinished(quint32 status, quint32 runtime)
                 newupdates = true;
             }
         }
+        // The updates could be withdrawn or their repos removed
+        for (const auto &name : d_ptr->newUpdatablePackages.keys())
+        {
+            if (!d_ptr->updatablePackages.contains(name))
+            {
+                emit this->packageStatusChanged(name, d_ptr->installedPackages.contains(name) ?
+                                                    OrnPm::PackageInstalled : OrnPm::PackageNotInstalled);
+                newupdates = true;
+            }
+        }
         if (newupdates)
         {
             emit this->updatablePackagesChanged();
@@ -304,10 +401,10 @@ void OrnPmPrivate::preparePackageVersions(const QString &packageName)
     auto spool = pool_create();
     auto srepo = repo_create(spool, "");
 
-    auto sfile = fopen(SOLV_INSTALLED, "r");
+    auto sfile = fopen(QFile::encodeName(SOLV_INSTALLED).constData(), "r");
     if (!sfile)
     {
-        qCritical() << "Could not read " SOLV_INSTALLED;
+        qCritical() << "Could not read" << SOLV_INSTALLED;
         repo_free(srepo, 0);
         pool_free(spool);
         return;
@@ -330,6 +427,7 @@ void OrnPmPrivate::preparePackageVersions(const QString &packageName)
     }
     repo_free(srepo, 0);
 
+    auto archs = sysInfo->archs();
     QString solvTmpl(SOLV_PATH_TMPL);
     for (auto it = repos.cbegin(); it != repos.cend(); ++it)
     {
@@ -378,26 +476,238 @@ void OrnPmPrivate::preparePackageVersions(const QString &packageName)
     emit q_ptr->packageVersions(packageName, versions);
 }
 
+void OrnPm::previewInstall(const QString &packageId)
+{
+    Q_ASSERT(!packageId.isEmpty());
+    CHECK_INITIALISED();
+    qDebug() << "Resolving dependencies for" << packageId;
+
+    QtConcurrent::run(d_ptr, &OrnPmPrivate::prepareInstallPreview, packageId);
+}
+
+Pool *OrnPmPrivate::loadPool()
+{
+    if (!poolDirty.testAndSetOrdered(1, 0))
+    {
+        return pool;
+    }
+
+    if (pool)
+    {
+        pool_free(pool);
+    }
+
+    qDebug() << "Loading solver pool";
+    pool = pool_create();
+    pool_setarch(pool, sysInfo->arch().toUtf8().data());
+
+    auto srepo = repo_create(pool, "installed");
+    auto sfile = fopen(QFile::encodeName(SOLV_INSTALLED).constData(), "r");
+    if (sfile)
+    {
+        repo_add_solv(srepo, sfile, 0);
+        fclose(sfile);
+        pool_set_installed(pool, srepo);
+    }
+    else
+    {
+        qCritical() << "Could not read" << SOLV_INSTALLED;
+    }
+
+    QString solvTmpl(SOLV_PATH_TMPL);
+    for (auto it = repos.cbegin(); it != repos.cend(); ++it)
+    {
+        if (!it.value())
+        {
+            continue;
+        }
+        const auto &alias = it.key();
+        auto spath = solvTmpl.arg(alias);
+        sfile = fopen(spath.toUtf8().data(), "r");
+        if (!sfile)
+        {
+            qCritical() << "Could not read" << spath;
+            continue;
+        }
+        srepo = repo_create(pool, alias.toUtf8().data());
+        repo_add_solv(srepo, sfile, 0);
+        fclose(sfile);
+    }
+
+    pool_addfileprovides(pool);
+    pool_createwhatprovides(pool);
+    qDebug() << "Solver pool with" << pool->nsolvables << "solvables loaded";
+    return pool;
+}
+
+void OrnPmPrivate::prepareInstallPreview(const QString &packageId)
+{
+    OrnInstallPreview preview{ 0, 0, packageId, QStringList(), QStringList(), QStringList() };
+
+    QMutexLocker locker(&poolMutex);
+    auto spool = this->loadPool();
+
+    // Find the solvable for the package id.
+    // Compare the UTF-8 bytes to avoid decoding every solvable.
+    OrnPackageId id(packageId);
+    Id sid = 0;
+    if (id.isValid())
+    {
+        auto name  = id.name().toUtf8();
+        auto evr   = id.version().toUtf8();
+        auto sarch = id.arch().toUtf8();
+        auto alias = id.repo().toUtf8();
+        for (int i = 2; i < spool->nsolvables && !sid; ++i)
+        {
+            auto s = &spool->solvables[i];
+            if (s->repo && alias == s->repo->name &&
+                name == pool_id2str(spool, s->name) &&
+                evr == pool_id2str(spool, s->evr) &&
+                sarch == pool_id2str(spool, s->arch))
+            {
+                sid = i;
+            }
+        }
+    }
+
+    if (!sid)
+    {
+        qWarning() << "Could not find package" << packageId << "in the solver pool";
+        preview.problems << QStringLiteral("Package %0 was not found").arg(packageId);
+        emit q_ptr->installPreview(preview);
+        return;
+    }
+
+    auto toId = [spool](Solvable *s)
+    {
+        return QStringLiteral("%0;%1;%2;%3").arg(pool_id2str(spool, s->name),
+                                                 pool_id2str(spool, s->evr),
+                                                 pool_id2str(spool, s->arch),
+                                                 s->repo->name);
+    };
+
+    Queue job;
+    queue_init(&job);
+    queue_push2(&job, SOLVER_INSTALL | SOLVER_SOLVABLE, sid);
+
+    auto solver = solver_create(spool);
+    auto problemsCount = solver_solve(solver, &job);
+    if (problemsCount)
+    {
+        for (Id problem = 1; problem <= Id(problemsCount); ++problem)
+        {
+            preview.problems << QString(solver_problem2str(solver, problem));
+        }
+        qDebug() << "Could not resolve dependencies for" << packageId << "-" << preview.problems;
+    }
+    else
+    {
+        auto trans = solver_create_transaction(solver);
+        for (int i = 0; i < trans->steps.count; ++i)
+        {
+            auto s = spool->solvables + trans->steps.elements[i];
+            if (s->repo == spool->installed)
+            {
+                preview.remove << toId(s);
+            }
+            else
+            {
+                preview.install << toId(s);
+                preview.downloadSize += solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0);
+                preview.installSize  += solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0);
+            }
+        }
+        transaction_free(trans);
+        qDebug() << "Installing" << packageId << "requires" << preview.install.size()
+                 << "packages with download size" << preview.downloadSize;
+    }
+
+    solver_free(solver);
+    queue_free(&job);
+
+    emit q_ptr->installPreview(preview);
+}
+
+void OrnPm::findPackages(const QString &query, bool prefix)
+{
+    Q_ASSERT(!query.isEmpty());
+    CHECK_INITIALISED();
+    qDebug() << "Searching" << (prefix ? "packages with prefix" : "package") << query;
+
+    QtConcurrent::run(d_ptr, &OrnPmPrivate::findPackages, query, prefix);
+}
+
+void OrnPmPrivate::findPackages(const QString &query, bool prefix)
+{
+    // Only the changed solv files are reread
+    packageIndex.update(sysInfo->archs());
+
+    OrnPackageVersionMap packages;
+    if (prefix)
+    {
+        packages = packageIndex.findPrefix(query);
+    }
+    else
+    {
+        auto versions = packageIndex.find(query);
+        if (!versions.isEmpty())
+        {
+            packages.insert(query, versions);
+        }
+    }
+
+    qDebug() << "Found" << packages.size() << "packages for" << query;
+    emit q_ptr->packagesFound(query, packages);
+}
+
+void OrnPm::getAvailablePackages()
+{
+    CHECK_INITIALISED();
+
+    QtConcurrent::run(d_ptr, &OrnPmPrivate::prepareAvailablePackages);
+}
+
+void OrnPmPrivate::prepareAvailablePackages()
+{
+    qDebug() << "Preparing available packages list";
+    packageIndex.update(sysInfo->archs());
+
+    StringSet enabled;
+    for (auto it = repos.cbegin(); it != repos.cend(); ++it)
+    {
+        if (it.value())
+        {
+            enabled.insert(it.key());
+        }
+    }
+
+    auto packages = packageIndex.packages(enabled);
+    qDebug() << packages.size() << "packages are available";
+    emit q_ptr->availablePackages(packages);
+}
+
 void OrnPm::installPackage(const QString &packageId)
 {
-    SET_OPERATION_ITEM(InstallingPackage, Orn::packageName(packageId));
+    auto name = OrnPackageId(packageId).name().toString();
+    SET_OPERATION_ITEM(InstallingPackage, name);
 
-    auto t = d_ptr->transaction();
+    auto t = d_ptr->transaction(PK_METHOD_INSTALLPACKAGES, packageId);
     connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onPackageInstalled(quint32,quint32)));
     QStringList ids(packageId);
     qDebug().nospace() << "Calling " << t << "->" PK_METHOD_INSTALLPACKAGES "(" << PK_FLAG_NONE << ", " << ids << ")";
-    emit this->packageStatusChanged(Orn::packageName(packageId), OrnPm::PackageInstalling);
+    emit this->packageStatusChanged(name, OrnPm::PackageInstalling);
     t->asyncCall(QStringLiteral(PK_METHOD_INSTALLPACKAGES), PK_FLAG_NONE, ids);
 }
 
 void OrnPm::onPackageInstalled(quint32 exit, quint32 runtime)
 {
     Q_UNUSED(runtime)
-    auto id = OrnPmPrivate::lastPackage(this->sender());
-    auto name = Orn::packageName(id);
+    OrnPackageId id(OrnPmPrivate::lastPackage(this->sender()));
+    auto name = id.name().toString();
     if (exit == Transaction::ExitSuccess)
     {
-        d_ptr->installedPackages[name] = Orn::packageVersion(id);
+        d_ptr->invalidatePool();
+        d_ptr->installedPackages[name] = id.version().toString();
         emit this->packageInstalled(name);
         emit this->packageStatusChanged(name, OrnPm::PackageInstalled);
     }
@@ -409,26 +719,111 @@ void OrnPm::onPackageInstalled(quint32 exit, quint32 runtime)
     emit this->operationsChanged();
 }
 
+QStringList OrnPm::installPackages(const QStringList &packageIds)
+{
+    CHECK_INITIALISED();
+
+    QStringList names;
+    QStringList ids;
+    for (const auto &packageId : packageIds)
+    {
+        auto name = OrnPackageId(packageId).name().toString();
+        if (d_ptr->operations.contains(name))
+        {
+            qWarning() << name << "is already being processed!";
+            continue;
+        }
+        names << name;
+        ids << packageId;
+    }
+
+    if (ids.isEmpty())
+    {
+        qDebug() << "No packages to install, skipping";
+        return ids;
+    }
+
+    for (const auto &name : names)
+    {
+        d_ptr->operations.insert(name, InstallingPackage);
+    }
+    emit this->operationsChanged();
+
+    // Install all the packages in a single transaction
+    auto t = d_ptr->transaction(PK_METHOD_INSTALLPACKAGES, ids.join(QChar(' ')));
+    d_ptr->batchInstalls.insert(t, ids);
+    connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onPackagesInstalled(quint32,quint32)));
+    qDebug().nospace() << "Calling " << t << "->" PK_METHOD_INSTALLPACKAGES "(" << PK_FLAG_NONE << ", " << ids << ")";
+    for (const auto &name : names)
+    {
+        emit this->packageStatusChanged(name, OrnPm::PackageInstalling);
+    }
+    t->asyncCall(QStringLiteral(PK_METHOD_INSTALLPACKAGES), PK_FLAG_NONE, ids);
+    return ids;
+}
+
+void OrnPm::onPackagesInstalled(quint32 exit, quint32 runtime)
+{
+    Q_UNUSED(runtime)
+    auto ids = d_ptr->batchInstalls.take(this->sender());
+    auto success = exit == Transaction::ExitSuccess;
+    if (success)
+    {
+        d_ptr->invalidatePool();
+    }
+    bool updatesChanged = false;
+    for (const auto &packageId : ids)
+    {
+        OrnPackageId id(packageId);
+        auto name = id.name().toString();
+        if (success)
+        {
+            // The installed version could be the pending update
+            if (d_ptr->updatablePackages.value(name) == packageId)
+            {
+                d_ptr->updatablePackages.remove(name);
+                updatesChanged = true;
+            }
+            d_ptr->installedPackages[name] = id.version().toString();
+            emit this->packageInstalled(name);
+            emit this->packageStatusChanged(name, OrnPm::PackageInstalled);
+        }
+        else
+        {
+            emit this->packageStatusChanged(name, OrnPm::PackageUnknownStatus);
+        }
+        d_ptr->operations.remove(name);
+    }
+    emit this->operationsChanged();
+    if (updatesChanged)
+    {
+        emit this->updatablePackagesChanged();
+    }
+    emit this->packagesInstalled(ids, success);
+}
+
 void OrnPm::removePackage(const QString &packageId, bool autoremove)
 {
-    SET_OPERATION_ITEM(RemovingPackage, Orn::packageName(packageId));
+    auto name = OrnPackageId(packageId).name().toString();
+    SET_OPERATION_ITEM(RemovingPackage, name);
 
-    auto t = d_ptr->transaction();
+    auto t = d_ptr->transaction(PK_METHOD_REMOVEPACKAGES, packageId);
     connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onPackageRemoved(quint32,quint32)));
     QStringList ids(packageId);
     qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REMOVEPACKAGES "("
                        << PK_FLAG_NONE << ", " << ids << ", false, " << autoremove << ")";
-    emit this->packageStatusChanged(Orn::packageName(packageId), OrnPm::PackageRemoving);
+    emit this->packageStatusChanged(name, OrnPm::PackageRemoving);
     t->asyncCall(QStringLiteral(PK_METHOD_REMOVEPACKAGES), PK_FLAG_NONE, ids, false, autoremove);
 }
 
 void OrnPm::onPackageRemoved(quint32 exit, quint32 runtime)
 {    
     Q_UNUSED(runtime)
-    auto id = OrnPmPrivate::lastPackage(this->sender());
-    auto name = Orn::packageName(id);
+    OrnPackageId id(OrnPmPrivate::lastPackage(this->sender()));
+    auto name = id.name().toString();
     if (exit == Transaction::ExitSuccess)
     {
+        d_ptr->invalidatePool();
         d_ptr->installedPackages.remove(name);
         emit this->packageRemoved(name);
         emit this->packageStatusChanged(name, OrnPm::PackageNotInstalled);
@@ -451,7 +846,7 @@ void OrnPm::updatePackage(const QString &packageName)
     SET_OPERATION_ITEM(UpdatingPackage, packageName);
 
     auto packageId = d_ptr->updatablePackages[packageName];
-    auto t = d_ptr->transaction();
+    auto t = d_ptr->transaction(PK_METHOD_UPDATEPACKAGES, packageId);
     connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onPackageUpdated(quint32,quint32)));
     QStringList ids(packageId);
     qDebug().nospace() << "Calling " << t << "->" PK_METHOD_UPDATEPACKAGES "(" << PK_FLAG_NONE << ", " << ids << ")";
@@ -462,12 +857,13 @@ void OrnPm::updatePackage(const QString &packageName)
 void OrnPm::onPackageUpdated(quint32 exit, quint32 runtime)
 {
     Q_UNUSED(runtime)
-    auto id = OrnPmPrivate::lastPackage(this->sender());
-    auto name = Orn::packageName(id);
+    OrnPackageId id(OrnPmPrivate::lastPackage(this->sender()));
+    auto name = id.name().toString();
     if (exit == Transaction::ExitSuccess)
     {
+        d_ptr->invalidatePool();
         d_ptr->updatablePackages.remove(name);
-        d_ptr->installedPackages[name] = Orn::packageVersion(id);
+        d_ptr->installedPackages[name] = id.version().toString();
         emit this->packageUpdated(name);
         emit this->packageStatusChanged(name, OrnPm::PackageInstalled);
     }
@@ -479,24 +875,252 @@ void OrnPm::onPackageUpdated(quint32 exit, quint32 runtime)
     emit this->operationsChanged();
 }
 
+void OrnPm::updatePackages(const QStringList &packageNames)
+{
+    CHECK_INITIALISED();
+
+    QStringList names;
+    QStringList ids;
+    for (const auto &name : packageNames)
+    {
+        if (!d_ptr->updatablePackages.contains(name))
+        {
+            qWarning() << "The package" << name << "has no updates!";
+            continue;
+        }
+        if (d_ptr->operations.contains(name))
+        {
+            qWarning() << name << "is already being processed!";
+            continue;
+        }
+        names << name;
+        ids << d_ptr->updatablePackages[name];
+    }
+
+    if (ids.isEmpty())
+    {
+        qDebug() << "No packages to update, skipping";
+        return;
+    }
+
+    for (const auto &name : names)
+    {
+        d_ptr->operations.insert(name, UpdatingPackage);
+    }
+    emit this->operationsChanged();
+
+    // Update all the packages in a single transaction
+    auto t = d_ptr->transaction(PK_METHOD_UPDATEPACKAGES, ids.join(QChar(' ')));
+    d_ptr->batchUpdates.insert(t, ids);
+    connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(onPackagesUpdated(quint32,quint32)));
+    qDebug().nospace() << "Calling " << t << "->" PK_METHOD_UPDATEPACKAGES "(" << PK_FLAG_NONE << ", " << ids << ")";
+    for (const auto &name : names)
+    {
+        emit this->packageStatusChanged(name, OrnPm::PackageUpdating);
+    }
+    t->asyncCall(QStringLiteral(PK_METHOD_UPDATEPACKAGES), PK_FLAG_NONE, ids);
+}
+
+void OrnPm::onPackagesUpdated(quint32 exit, quint32 runtime)
+{
+    Q_UNUSED(runtime)
+    auto ids = d_ptr->batchUpdates.take(this->sender());
+    if (exit == Transaction::ExitSuccess)
+    {
+        d_ptr->invalidatePool();
+    }
+    for (const auto &packageId : ids)
+    {
+        OrnPackageId id(packageId);
+        auto name = id.name().toString();
+        if (exit == Transaction::ExitSuccess)
+        {
+            d_ptr->updatablePackages.remove(name);
+            d_ptr->installedPackages[name] = id.version().toString();
+            emit this->packageUpdated(name);
+            emit this->packageStatusChanged(name, OrnPm::PackageInstalled);
+        }
+        else
+        {
+            emit this->packageStatusChanged(name, OrnPm::PackageUnknownStatus);
+        }
+        d_ptr->operations.remove(name);
+    }
+    emit this->operationsChanged();
+    if (exit == Transaction::ExitSuccess)
+    {
+        emit this->updatablePackagesChanged();
+    }
+}
+
 void OrnPm::addRepo(const QString &author)
 {
     CHECK_INITIALISED();
 
     auto repoAlias = repoNamePrefix + author;
     SET_OPERATION_ITEM(AddingRepo, repoAlias);
-    auto url = REPO_URL_TMPL.arg(author);
-    qDebug().nospace() << "Calling " << d_ptr->ssuInterface << "->" SSU_METHOD_ADDREPO "("
-                       << repoAlias << ", " << url << ")";
-    auto watcher = new QDBusPendingCallWatcher(
-                d_ptr->ssuInterface->asyncCall(QStringLiteral(SSU_METHOD_ADDREPO), repoAlias, url));
+    auto watcher = d_ptr->ssuAddRepo(repoAlias);
     connect(watcher, &QDBusPendingCallWatcher::finished, [this, watcher, repoAlias]()
     {
-        d_ptr->onRepoModified(repoAlias, AddRepo);
         watcher->deleteLater();
+        if (!d_ptr->ssuCallFinished(watcher, repoAlias))
+        {
+            d_ptr->operations.remove(repoAlias);
+            emit this->operationsChanged();
+            return;
+        }
+        d_ptr->onRepoModified(repoAlias, AddRepo);
     });
 }
 
+QDBusPendingCallWatcher *OrnPmPrivate::ssuAddRepo(const QString &repoAlias, QObject *parent)
+{
+    QString method(QStringLiteral(SSU_METHOD_ADDREPO));
+    auto url = REPO_URL_TMPL.arg(repoAlias.mid(OrnPm::repoNamePrefix.size()));
+    qDebug().nospace() << "Calling " << ssuInterface << "->" SSU_METHOD_ADDREPO "("
+                       << repoAlias << ", " << url << ")";
+    auto watcher = new QDBusPendingCallWatcher(
+                ssuInterface->asyncCall(method, repoAlias, url), parent);
+    journal->begin(watcher, method, repoAlias);
+    return watcher;
+}
+
+QDBusPendingCallWatcher *OrnPmPrivate::ssuModifyRepo(const QString &repoAlias,
+                                                     const OrnPm::RepoAction &action, QObject *parent)
+{
+    QString method(QStringLiteral(SSU_METHOD_MODIFYREPO));
+    qDebug().nospace() << "Calling " << ssuInterface << "->" SSU_METHOD_MODIFYREPO "("
+                       << action << ", " << repoAlias << ")";
+    auto watcher = new QDBusPendingCallWatcher(
+                ssuInterface->asyncCall(method, action, repoAlias), parent);
+    journal->begin(watcher, method, repoAlias);
+    return watcher;
+}
+
+bool OrnPmPrivate::ssuCallFinished(QDBusPendingCallWatcher *watcher, const QString &repoAlias)
+{
+    auto error = watcher->isError();
+    journal->end(watcher, error ? Transaction::ExitFailed : Transaction::ExitSuccess);
+    if (error)
+    {
+        qWarning() << "ssu call for repo" << repoAlias << "failed -" << watcher->error().message();
+    }
+    return !error;
+}
+
+void OrnPmPrivate::insertRepo(const QString &repoAlias, bool enabled)
+{
+    repos.insert(repoAlias, enabled);
+    this->invalidatePool();
+    emit q_ptr->repoModified(repoAlias, OrnPm::AddRepo);
+}
+
+void OrnPmPrivate::setOperation(const QString &item, const OrnPm::Operation &operation)
+{
+    operations.insert(item, operation);
+    emit q_ptr->operationsChanged();
+}
+
+void OrnPmPrivate::removeOperation(const QString &item)
+{
+    if (operations.remove(item))
+    {
+        emit q_ptr->operationsChanged();
+    }
+}
+
+void OrnPm::addRepos(const QStringList &authors)
+{
+    CHECK_INITIALISED();
+
+    int added = 0;
+    for (const auto &author : authors)
+    {
+        auto repoAlias = repoNamePrefix + author;
+        if (d_ptr->repos.contains(repoAlias) || d_ptr->operations.contains(repoAlias))
+        {
+            qDebug() << "Skipping repo" << repoAlias;
+            continue;
+        }
+        d_ptr->operations.insert(repoAlias, AddingRepo);
+        ++added;
+
+        // Add all the repos asynchronously at once
+        auto watcher = d_ptr->ssuAddRepo(repoAlias);
+        connect(watcher, &QDBusPendingCallWatcher::finished, [this, watcher, repoAlias]()
+        {
+            watcher->deleteLater();
+            if (!d_ptr->ssuCallFinished(watcher, repoAlias))
+            {
+                d_ptr->onAddedRepoFinished(repoAlias, false);
+                return;
+            }
+            d_ptr->invalidatePool();
+            d_ptr->repos.insert(repoAlias, true);
+            d_ptr->operations[repoAlias] = RefreshingRepo;
+            emit this->operationsChanged();
+            d_ptr->addedReposToRefresh << repoAlias;
+            d_ptr->refreshAddedRepos();
+        });
+    }
+
+    if (added == 0)
+    {
+        qDebug() << "No repos to add";
+        return;
+    }
+
+    emit this->operationsChanged();
+    d_ptr->addedReposTotal += added;
+    emit this->addReposProgress(d_ptr->addedReposFinished, d_ptr->addedReposTotal);
+}
+
+void OrnPmPrivate::refreshAddedRepos()
+{
+    // Refresh only the new repos with the limited number of transactions
+    while (addedReposRefreshing < MAX_PARALLEL_REFRESHES && !addedReposToRefresh.isEmpty())
+    {
+        auto repoAlias = addedReposToRefresh.takeFirst();
+        ++addedReposRefreshing;
+        auto t = this->transaction(PK_METHOD_REPOSETDATA, repoAlias);
+        qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REPOSETDATA "("
+                           << repoAlias << ", \"refresh-now\", false)";
+        t->asyncCall(QStringLiteral(PK_METHOD_REPOSETDATA), repoAlias,
+                     QStringLiteral("refresh-now"), QStringLiteral("false"));
+        QObject::connect(t, &QDBusInterface::destroyed, [this, repoAlias]()
+        {
+            this->onAddedRepoFinished(repoAlias, true);
+        });
+    }
+}
+
+void OrnPmPrivate::onAddedRepoFinished(const QString &repoAlias, bool added)
+{
+    ++addedReposFinished;
+    operations.remove(repoAlias);
+    emit q_ptr->operationsChanged();
+    if (added)
+    {
+        --addedReposRefreshing;
+        this->invalidatePool();
+        emit q_ptr->repoModified(repoAlias, OrnPm::AddRepo);
+        qDebug() << "Repo" << repoAlias << "have been added";
+    }
+    emit q_ptr->addReposProgress(addedReposFinished, addedReposTotal);
+
+    if (addedReposFinished == addedReposTotal)
+    {
+        qDebug() << "Finished adding" << addedReposTotal << "repos";
+        addedReposFinished = 0;
+        addedReposTotal = 0;
+        emit q_ptr->addReposFinished();
+    }
+    else
+    {
+        this->refreshAddedRepos();
+    }
+}
+
 void OrnPm::modifyRepo(const QString &repoAlias, const OrnPm::RepoAction &action)
 {
     CHECK_INITIALISED();
@@ -519,67 +1143,201 @@ void OrnPm::modifyRepo(const QString &repoAlias, const OrnPm::RepoAction &action
     }
     SET_OPERATION_ITEM(op, repoAlias);
 
-    qDebug().nospace() << "Calling " << d_ptr->ssuInterface << "->" SSU_METHOD_MODIFYREPO "("
-                       << action << ", " << repoAlias << ")";
-    auto watcher = new QDBusPendingCallWatcher(
-                d_ptr->ssuInterface->asyncCall(QStringLiteral(SSU_METHOD_MODIFYREPO), action, repoAlias));
+    auto watcher = d_ptr->ssuModifyRepo(repoAlias, action);
     connect(watcher, &QDBusPendingCallWatcher::finished, [this, watcher, repoAlias, action]()
     {
-        d_ptr->onRepoModified(repoAlias, action);
         watcher->deleteLater();
+        if (!d_ptr->ssuCallFinished(watcher, repoAlias))
+        {
+            d_ptr->operations.remove(repoAlias);
+            emit this->operationsChanged();
+            return;
+        }
+        d_ptr->onRepoModified(repoAlias, action);
     });
 }
 
 void OrnPm::enableRepos(bool enable)
 {
     CHECK_INITIALISED();
+    if (d_ptr->enablingRepos)
+    {
+        qWarning() << "Repositories are already being modified!";
+        return;
+    }
+
+    // The repos are read and changed only in this thread
+    QStringList aliases;
+    for (auto it = d_ptr->repos.cbegin(); it != d_ptr->repos.cend(); ++it)
+    {
+        if (it.value() != enable)
+        {
+            aliases << it.key();
+        }
+    }
 
-    QtConcurrent::run(d_ptr, &OrnPmPrivate::enableRepos, enable);
+    d_ptr->enablingRepos = true;
+    ++d_ptr->reposGeneration;
+    qDebug() << (enable ? "Enabling" : "Disabling") << "all repositories";
+    auto fw = new QFutureWatcher<QStringList>(this);
+    connect(fw, &QFutureWatcher<QStringList>::finished, [this, fw, enable]()
+    {
+        fw->deleteLater();
+        d_ptr->onReposEnabled(fw->result(), enable);
+    });
+    fw->setFuture(QtConcurrent::run(d_ptr, &OrnPmPrivate::enableRepos, aliases, enable));
 }
 
-void OrnPmPrivate::enableRepos(bool enable)
+QStringList OrnPmPrivate::enableRepos(const QStringList &aliases, bool enable)
 {
-    qDebug() << (enable ? "Enabling" : "Disabling") << "all repositories";
     QString method(QStringLiteral(SSU_METHOD_MODIFYREPO));
+    auto action = enable ? OrnPm::EnableRepo : OrnPm::DisableRepo;
+    QStringList modified;
+    for (const auto &alias : aliases)
+    {
+        auto start = QDateTime::currentMSecsSinceEpoch();
+        auto reply = ssuInterface->call(method, action, alias);
+        auto failed = reply.type() == QDBusMessage::ErrorMessage;
+        journal->record(method, alias, start, failed ? Transaction::ExitFailed : Transaction::ExitSuccess);
+        if (!failed)
+        {
+            modified << alias;
+        }
+    }
+    return modified;
+}
 
-    if (enable)
+void OrnPmPrivate::onReposEnabled(const QStringList &aliases, bool enable)
+{
+    for (const auto &alias : aliases)
     {
-        bool needRefresh = false;
-        for (auto it = repos.begin(); it != repos.end(); ++it)
+        if (repos.contains(alias))
         {
-            if (!it.value())
-            {
-                ssuInterface->call(method, OrnPm::EnableRepo, it.key());
-                *it = true;
-                needRefresh = true;
-            }
+            repos[alias] = enable;
         }
-        if (needRefresh)
+    }
+
+    if (enable)
+    {
+        if (!aliases.isEmpty())
         {
             q_ptr->refreshRepos();
         }
     }
     else
     {
-        for (auto it = repos.begin(); it != repos.end(); ++it)
-        {
-            if (it.value())
-            {
-                ssuInterface->call(method, OrnPm::DisableRepo, it.key());
-                *it = false;
-            }
-        }
         updatablePackages.clear();
         emit q_ptr->updatablePackagesChanged();
     }
 
+    this->invalidatePool();
+    enablingRepos = false;
+    // Drop the config snapshots read while enabling
+    ++reposGeneration;
     qDebug() << "Finished" << (enable ? "enabling" : "disabling") << "all repositories";
     emit q_ptr->enableReposFinished();
+    // Catch up with the changes made by other apps meanwhile
+    this->onSsuConfigChanged();
+}
+
+OrnPmPrivate::RepoHash OrnPmPrivate::readRepos()
+{
+    // NOTE: A hack for SSU repos. Can break on ssu config changes.
+    QSettings ssuSettings(SSU_CONFIG_PATH, QSettings::IniFormat);
+
+    auto disabled = ssuSettings.value(SSU_DISABLED_KEY).toStringList().toSet();
+    ssuSettings.beginGroup(SSU_REPOS_GROUP);
+    auto aliases = ssuSettings.childKeys();
+
+    RepoHash res;
+    for (const auto &alias : aliases)
+    {
+        if (alias.startsWith(OrnPm::repoNamePrefix))
+        {
+            auto enabled = !disabled.contains(alias);
+            qDebug() << "Found" << (enabled ? "enabled" : "disabled") << "repo" << alias;
+            res.insert(alias, enabled);
+        }
+    }
+    return res;
+}
+
+void OrnPmPrivate::onSsuConfigChanged()
+{
+    if (!initialised)
+    {
+        return;
+    }
+
+    auto generation = reposGeneration;
+    auto fw = new QFutureWatcher<RepoHash>(q_ptr);
+    QObject::connect(fw, &QFutureWatcher<RepoHash>::finished, [this, fw, generation]()
+    {
+        fw->deleteLater();
+        // Repos are being modified by OrnPm itself or
+        // the snapshot was read before that had finished
+        if (enablingRepos || generation != reposGeneration)
+        {
+            return;
+        }
+        this->applyRepos(fw->result());
+    });
+    fw->setFuture(QtConcurrent::run(&OrnPmPrivate::readRepos));
+}
+
+void OrnPmPrivate::applyRepos(const RepoHash &newRepos)
+{
+    // Apply only the changes made by other apps, the repos
+    // with pending operations are handled by their own callbacks
+    QList<QPair<QString, OrnPm::RepoAction>> changes;
+    for (auto it = repos.cbegin(); it != repos.cend(); ++it)
+    {
+        const auto &alias = it.key();
+        if (operations.contains(alias))
+        {
+            continue;
+        }
+        auto nit = newRepos.find(alias);
+        if (nit == newRepos.cend())
+        {
+            changes << qMakePair(alias, OrnPm::RemoveRepo);
+        }
+        else if (nit.value() != it.value())
+        {
+            changes << qMakePair(alias, nit.value() ? OrnPm::EnableRepo : OrnPm::DisableRepo);
+        }
+    }
+    for (auto it = newRepos.cbegin(); it != newRepos.cend(); ++it)
+    {
+        const auto &alias = it.key();
+        if (!repos.contains(alias) && !operations.contains(alias))
+        {
+            changes << qMakePair(alias, it.value() ? OrnPm::AddRepo : OrnPm::DisableRepo);
+        }
+    }
+
+    if (changes.isEmpty())
+    {
+        return;
+    }
+
+    qDebug() << "Applying" << changes.size() << "external repo changes";
+    for (const auto &change : changes)
+    {
+        // A disabled repo was added, just remember it
+        if (change.second == OrnPm::DisableRepo && !repos.contains(change.first))
+        {
+            this->insertRepo(change.first, false);
+            continue;
+        }
+        this->onRepoModified(change.first, change.second);
+    }
 }
 
 void OrnPmPrivate::onRepoModified(const QString &repoAlias, const OrnPm::RepoAction &action)
 {
     bool needRefresh = false;
+    this->invalidatePool();
 
     switch (action)
     {
@@ -605,13 +1363,14 @@ void OrnPmPrivate::onRepoModified(const QString &repoAlias, const OrnPm::RepoAct
     {
         operations[repoAlias] = OrnPm::RefreshingRepo;
         emit q_ptr->operationsChanged();
-        auto t = this->transaction();
+        auto t = this->transaction(PK_METHOD_REPOSETDATA, repoAlias);
         qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REPOSETDATA "("
                            << repoAlias << ", \"refresh-now\", false)";
         t->asyncCall(QStringLiteral(PK_METHOD_REPOSETDATA), repoAlias,
                      QStringLiteral("refresh-now"), QStringLiteral("false"));
         QObject::connect(t, &QDBusInterface::destroyed, [this, repoAlias, action]()
         {
+            this->invalidatePool();
             operations.remove(repoAlias);
             emit q_ptr->operationsChanged();
             emit q_ptr->repoModified(repoAlias, action);
@@ -630,15 +1389,17 @@ void OrnPmPrivate::onRepoModified(const QString &repoAlias, const OrnPm::RepoAct
 void OrnPm::refreshRepo(const QString &repoAlias, bool force)
 {
     SET_OPERATION_ITEM(RefreshingRepo, repoAlias);
-    auto t = d_ptr->transaction();
+    auto t = d_ptr->transaction(PK_METHOD_REPOSETDATA, repoAlias);
     connect(t, &QDBusInterface::destroyed, [this, repoAlias]()
     {
+        d_ptr->invalidatePool();
         d_ptr->operations.remove(repoAlias);
         emit this->operationsChanged();
+        emit this->reposRefreshed();
     });
-    qDebug().nospace() << "Calling " << t << "->RepoSetData(" << repoAlias
+    qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REPOSETDATA "(" << repoAlias
                        << ", \"refresh-now\", " << (force ? "true" : "false") << ")";
-    t->asyncCall(QStringLiteral("RepoSetData"), repoAlias, QStringLiteral("refresh-now"),
+    t->asyncCall(QStringLiteral(PK_METHOD_REPOSETDATA), repoAlias, QStringLiteral("refresh-now"),
                  force ? QStringLiteral("true") : QStringLiteral("false"));
 }
 
@@ -686,13 +1447,15 @@ void OrnPm::refreshNextRepo(quint32 exit, quint32 runtime)
         qDebug() << "Finished refreshing cache for all ORN repositories in"
                  << d_ptr->refreshRuntime << "msec";
 #endif
+        d_ptr->invalidatePool();
         d_ptr->pkInterface->blockSignals(false);
+        emit this->reposRefreshed();
     }
     else
     {
-        auto t = d_ptr->transaction();
-        connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(refreshNextRepo(quint32,quint32)));
         auto alias = d_ptr->reposToRefresh.takeFirst();
+        auto t = d_ptr->transaction(PK_METHOD_REPOSETDATA, alias);
+        connect(t, SIGNAL(Finished(quint32,quint32)), this, SLOT(refreshNextRepo(quint32,quint32)));
         qDebug().nospace() << "Calling " << t << "->" PK_METHOD_REPOSETDATA "("
                            << alias << ", \"refresh-now\", " << d_ptr->forceRefresh << ")";
         t->asyncCall(QStringLiteral(PK_METHOD_REPOSETDATA), alias, QStringLiteral("refresh-now"),
@@ -856,3 +1619,93 @@ void OrnPmPrivate::prepareInstalledPackages(const QString &packageName)
 
     emit q_ptr->installedPackages(packages);
 }
+
+void OrnPm::getUpdatablePackagesInfo(const QString &packageName)
+{
+    QtConcurrent::run(d_ptr, &OrnPmPrivate::prepareUpdatablePackagesInfo, packageName);
+}
+
+void OrnPmPrivate::prepareUpdatablePackagesInfo(const QString &packageName)
+{
+    OrnUpdatablePackageList packages;
+
+    // Group update ids by repositories to read each solv file only once
+    QHash<QString, StringHash> repoUpdates;
+    if (packageName.isEmpty())
+    {
+        for (auto it = updatablePackages.cbegin(); it != updatablePackages.cend(); ++it)
+        {
+            repoUpdates[OrnPackageId(it.value()).repo().toString()].insert(it.key(), it.value());
+        }
+    }
+    else if (updatablePackages.contains(packageName))
+    {
+        auto id = updatablePackages.value(packageName);
+        repoUpdates[OrnPackageId(id).repo().toString()].insert(packageName, id);
+    }
+
+    if (repoUpdates.isEmpty())
+    {
+        qDebug() << "No updatable packages";
+        emit q_ptr->updatablePackagesInfo(packageName, packages);
+        return;
+    }
+    qDebug() << "Preparing updatable packages list";
+
+    QString solvTmpl(SOLV_PATH_TMPL);
+    auto spool = pool_create();
+    for (auto it = repoUpdates.cbegin(); it != repoUpdates.cend(); ++it)
+    {
+        const auto &alias = it.key();
+        auto updates = it.value();
+        auto spath = solvTmpl.arg(alias);
+        qDebug() << "Reading" << spath;
+        auto srepo = repo_create(spool, alias.toUtf8().data());
+
+        auto sfile = fopen(spath.toUtf8().data(), "r");
+        if (sfile)
+        {
+            repo_add_solv(srepo, sfile, 0);
+            fclose(sfile);
+            for (int i = 0; i < spool->nsolvables && !updates.isEmpty(); ++i)
+            {
+                auto s = &spool->solvables[i];
+                QString name(solvable_lookup_str(s, SOLVABLE_NAME));
+                if (!updates.contains(name))
+                {
+                    continue;
+                }
+                OrnPackageId id(updates[name]);
+                if (id.version() == QString::fromUtf8(solvable_lookup_str(s, SOLVABLE_EVR)) &&
+                    id.arch() == QString::fromUtf8(solvable_lookup_str(s, SOLVABLE_ARCH)))
+                {
+                    packages << OrnUpdatablePackage{
+                        solvable_lookup_num(s, SOLVABLE_DOWNLOADSIZE, 0),
+                        solvable_lookup_num(s, SOLVABLE_INSTALLSIZE, 0),
+                        name,
+                        id.toString(),
+                        id.version().toString(),
+                        alias
+                    };
+                    updates.remove(name);
+                }
+            }
+        }
+        else
+        {
+            qCritical() << "Could not read" << spath;
+        }
+        repo_free(srepo, 0);
+
+        // Add the packages without solv data with unknown sizes
+        for (auto uit = updates.cbegin(); uit != updates.cend(); ++uit)
+        {
+            packages << OrnUpdatablePackage{
+                0, 0, uit.key(), uit.value(), OrnPackageId(uit.value()).version().toString(), alias
+            };
+        }
+    }
+    pool_free(spool);
+
+    emit q_ptr->updatablePackagesInfo(packageName, packages);
+}
@@ -1,14 +1,18 @@
 #ifndef ORNPM_H
 #define ORNPM_H
 
+#include "ornpackageversion.h"
+#include "orntransactionjournal.h"
+
 #include <QObject>
 
 #include <PackageKit/packagekit-qt5/Transaction>
 
 class QQmlEngine;
 class QJSEngine;
-class OrnPackageVersion;
 class OrnInstalledPackage;
+class OrnUpdatablePackage;
+class OrnInstallPreview;
 class OrnRepo;
 
 struct OrnPmPrivate;
@@ -17,12 +21,15 @@ class OrnPm : public QObject
 {
     friend class OrnPmPrivate;
     friend class OrnBackup;
+    friend class tst_OrnPm;
 
     Q_OBJECT
 
     Q_PROPERTY(bool initialised READ initialised NOTIFY initialisedChanged)
     Q_PROPERTY(QVariantList operations READ operations NOTIFY operationsChanged)
-    Q_PROPERTY(QString deviceModel READ deviceModel CONSTANT)
+    Q_PROPERTY(QString deviceModel READ deviceModel NOTIFY deviceModelChanged)
+    Q_PROPERTY(QString release READ release NOTIFY releaseChanged)
+    Q_PROPERTY(OrnTransactionJournal *journal READ journal CONSTANT)
     Q_PROPERTY(bool updatesAvailable READ updatesAvailable NOTIFY updatablePackagesChanged)
 
 public:
@@ -96,6 +103,8 @@ public:
     QVariantList operations() const;
 
     QString deviceModel() const;
+    QString release() const;
+    OrnTransactionJournal *journal() const;
 
     bool updatesAvailable() const;
     QStringList updatablePackages() const;
@@ -106,12 +115,14 @@ public:
 signals:
     void initialisedChanged();
     void operationsChanged();
+    void deviceModelChanged();
+    void releaseChanged();
     void packageStatusChanged(const QString &packageName, const PackageStatus &status);
     void error(quint32 code, const QString &details);
 
 private slots:
-#ifdef QT_DEBUG
     void onTransactionFinished(quint32 exit, quint32 runtime);
+#ifdef QT_DEBUG
     void emitError(quint32 code, QString details);
 #endif
 
@@ -129,13 +140,36 @@ signals:
 public slots:
     void getPackageVersions(const QString &packageName);
 
+    // Resolve dependencies of a package locally
+signals:
+    void installPreview(const OrnInstallPreview &preview);
+public slots:
+    void previewInstall(const QString &packageId);
+
+    // Find packages in all the ORN repositories including disabled ones
+signals:
+    void packagesFound(const QString &query, const OrnPackageVersionMap &packages);
+public slots:
+    void findPackages(const QString &query, bool prefix = false);
+
+    // Get packages from the enabled ORN repositories
+signals:
+    void availablePackages(const OrnPackageVersionMap &packages);
+public slots:
+    void getAvailablePackages();
+
     // Install package
 signals:
     void packageInstalled(const QString &packageName);
+    void packagesInstalled(const QStringList &packageIds, bool success);
 public slots:
     void installPackage(const QString &packageId);
+    /// Install the packages in a single transaction, returns the ids being installed.
+    /// The packages which are already being processed are skipped.
+    QStringList installPackages(const QStringList &packageIds);
 private slots:
     void onPackageInstalled(quint32 exit, quint32 runtime);
+    void onPackagesInstalled(quint32 exit, quint32 runtime);
 
     // Remove package
 signals:
@@ -150,19 +184,26 @@ signals:
     void packageUpdated(const QString &packageName);
 public slots:
     void updatePackage(const QString &packageName);
+    void updatePackages(const QStringList &packageNames);
 private slots:
     void onPackageUpdated(quint32 exit, quint32 runtime);
+    void onPackagesUpdated(quint32 exit, quint32 runtime);
 
     // SSU repo actions
 signals:
     void repoModified(const QString &repoAlias, const RepoAction &action);
     void enableReposFinished();
+    void addReposProgress(int finished, int total);
+    void addReposFinished();
 public slots:
     void addRepo(const QString &author);
+    void addRepos(const QStringList &authors);
     void modifyRepo(const QString &repoAlias, const RepoAction &action);
     void enableRepos(bool enable);
 
     // Refresh repos
+signals:
+    void reposRefreshed();
 public slots:
     void refreshRepo(const QString &repoAlias, bool force = false);
     void refreshRepos(bool force = false);
@@ -179,6 +220,13 @@ signals:
 public slots:
     void getInstalledPackages(const QString &packageName = QString());
 
+    // Get updatable packages with their sizes.
+    // The package name is empty for the list of all updatable packages.
+signals:
+    void updatablePackagesInfo(const QString &packageName, const QList<OrnUpdatablePackage> &packages);
+public slots:
+    void getUpdatablePackagesInfo(const QString &packageName = QString());
+
 private:
     explicit OrnPm(QObject *parent = nullptr);
     ~OrnPm();
@@ -1,19 +1,14 @@
 #ifndef ORNPM_P_H
 #define ORNPM_P_H
 
+#include "ornssu.h"
 
-#define SSU_CONFIG_PATH        QStringLiteral("/etc/ssu/ssu.ini")
-#define SSU_REPOS_GROUP        QStringLiteral("repository-urls")
-#define SSU_DISABLED_KEY       QStringLiteral("disabled-repos")
+// "system", "session" or a D-Bus address
+#define ORN_PM_BUS             ORN_ENV("ORN_PM_BUS", "system")
 
-#define SSU_SERVICE            QStringLiteral("org.nemo.ssu")
-#define SSU_PATH               QStringLiteral("/org/nemo/ssu")
-#define SSU_METHOD_DISPLAYNAME "displayName"
-#define SSU_METHOD_ADDREPO     "addRepo"
-#define SSU_METHOD_MODIFYREPO  "modifyRepo"
-
-#define PK_SERVICE      QStringLiteral("org.freedesktop.PackageKit")
-#define PK_PATH         QStringLiteral("/org/freedesktop/PackageKit")
+#define PK_SERVICE      ORN_ENV("ORN_PK_SERVICE", "org.freedesktop.PackageKit")
+#define PK_PATH         ORN_ENV("ORN_PK_PATH", "/org/freedesktop/PackageKit")
+#define PK_INTERFACE    QStringLiteral("org.freedesktop.PackageKit")
 #define PK_TR_INTERFACE QStringLiteral("org.freedesktop.PackageKit.Transaction")
 
 #define PK_METHOD_GETUPDATES        "GetUpdates"
@@ -21,50 +16,97 @@
 #define PK_METHOD_REMOVEPACKAGES    "RemovePackages"
 #define PK_METHOD_UPDATEPACKAGES    "UpdatePackages"
 #define PK_METHOD_REPOSETDATA       "RepoSetData"
+#define PK_METHOD_REFRESHCACHE      "RefreshCache"
 
 #define PK_PROP_LASTPACKAGE         "LastPackage"
 
 #define PK_FLAG_NONE  quint64(0)
 
+// The maximum number of repos refreshed simultaneously by OrnPm::addRepos()
+#define MAX_PARALLEL_REFRESHES 3
+
 #define REPO_URL_TMPL  QStringLiteral("https://sailfish.openrepos.net/%0/personal/main")
-#define SOLV_PATH_TMPL QStringLiteral("/var/cache/zypp/solv/%0/solv")
-#define SOLV_INSTALLED "/var/cache/zypp/solv/@System/solv"
+// Set ORN_SOLV_ROOT to the dir of scripts/generate_solv_corpus.py, see tests/benchmarks/ornpm
+#define SOLV_CACHE_DIR ORN_ENV("ORN_SOLV_ROOT", "/var/cache/zypp/solv")
+#define SOLV_PATH_TMPL (SOLV_CACHE_DIR + QStringLiteral("/%0/solv"))
+#define SOLV_INSTALLED (SOLV_CACHE_DIR + QStringLiteral("/@System/solv"))
 
 
 #include "ornpm.h"
+#include "ornpackageindex.h"
+#include "ornsysteminfo.h"
+#include "orntransactionjournal.h"
 
 #include <QSet>
+#include <QMutex>
+#include <QAtomicInt>
 
 #include <QtDBus/QDBusConnection>
 #include <QtDBus/QDBusInterface>
 #include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusPendingReply>
+
+#include <solv/pool.h>
 
 
 struct OrnPmPrivate
 {
     OrnPmPrivate(OrnPm *ornPm);
+    ~OrnPmPrivate();
+
+    // The bus of the PackageKit and SSU services
+    static QDBusConnection bus();
 
     void initialise();
-    QDBusInterface *transaction();
+    // Create a PackageKit transaction and journal it as the given kind
+    QDBusInterface *transaction(const char *kind, const QString &item = QString());
+    // Call ssu asynchronously and journal the call
+    QDBusPendingCallWatcher *ssuAddRepo(const QString &repoAlias, QObject *parent = nullptr);
+    QDBusPendingCallWatcher *ssuModifyRepo(const QString &repoAlias, const OrnPm::RepoAction &action,
+                                           QObject *parent = nullptr);
+    // End the journal entry of a finished ssu call, false if the call failed
+    bool ssuCallFinished(QDBusPendingCallWatcher *watcher, const QString &repoAlias);
+    // Remember a repo added without refreshing it
+    void insertRepo(const QString &repoAlias, bool enabled);
+    // Mark the item as processed, so the SSU config watcher skips it
+    void setOperation(const QString &item, const OrnPm::Operation &operation);
+    void removeOperation(const QString &item);
     void preparePackageVersions(const QString &packageName);
-    void enableRepos(bool enable);
+    // Modify the repos in the SSU, returns the modified aliases
+    QStringList enableRepos(const QStringList &aliases, bool enable);
+    void onReposEnabled(const QStringList &aliases, bool enable);
     void onRepoModified(const QString &repoAlias, const OrnPm::RepoAction &action);
+    void refreshAddedRepos();
+    void onAddedRepoFinished(const QString &repoAlias, bool added);
     void prepareInstalledPackages(const QString &packageName);
+    void prepareUpdatablePackagesInfo(const QString &packageName);
+    void prepareInstallPreview(const QString &packageId);
+    void findPackages(const QString &query, bool prefix);
+    void prepareAvailablePackages();
+
+    // Solver pool of the installed packages and enabled repositories.
+    // Lock the poolMutex before calling.
+    Pool *loadPool();
+    inline void invalidatePool()
+    { poolDirty.store(1); }
 
-    static inline QString lastPackage(QObject *t)
-    {
-        Q_ASSERT(t);
-        return static_cast<QDBusInterface *>(t)->
-                property(PK_PROP_LASTPACKAGE).toString();
-    }
+    // Read the LastPackage property of a finished transaction
+    static QString lastPackage(QObject *t);
 
     // <alias, enabled>
     typedef QHash<QString, bool>    RepoHash;
     typedef QSet<QString>           StringSet;
     typedef QHash<QString, QString> StringHash;
 
+    // Read the ORN repos from the SSU config
+    static RepoHash readRepos();
+    void onSsuConfigChanged();
+    // Apply the repo changes made outside of OrnPm
+    void applyRepos(const RepoHash &newRepos);
+
     bool            initialised;
-    StringSet       archs;
+    OrnSystemInfo   *sysInfo;
+    OrnTransactionJournal *journal;
     QDBusInterface  *ssuInterface;
     QDBusInterface  *pkInterface;
     RepoHash        repos;
@@ -72,8 +114,25 @@ struct OrnPmPrivate
     StringHash      updatablePackages;
     StringHash      newUpdatablePackages;
     QHash<QString, OrnPm::Operation> operations;
+    // <transaction, updated package ids>
+    QHash<QObject *, QStringList> batchUpdates;
+    // <transaction, installed package ids>
+    QHash<QObject *, QStringList> batchInstalls;
     QStringList     reposToRefresh;
+    // Bulk repos adding state
+    QStringList     addedReposToRefresh;
+    int             addedReposRefreshing;
+    int             addedReposFinished;
+    int             addedReposTotal;
     QString         forceRefresh;
+    Pool            *pool;
+    QMutex          poolMutex;
+    QAtomicInt      poolDirty;
+    bool            enablingRepos;
+    // Changed when OrnPm modifies the repos, the SSU config
+    // snapshots read before that are outdated
+    quint32         reposGeneration;
+    OrnPackageIndex packageIndex;
 #ifdef QT_DEBUG
     quint64         refreshRuntime;
 #endif
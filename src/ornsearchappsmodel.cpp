@@ -5,7 +5,8 @@ OrnSearchAppsModel::OrnSearchAppsModel(QObject *parent) :
     OrnAbstractAppsModel(true, parent)
 {
     mCanFetchMore = false;
-    connect(mApiRequest, &OrnApiRequest::jsonReady, this, &OrnSearchAppsModel::resultsUpdated);
+    // The pages can also come from the prefetch requests
+    connect(this, &OrnAbstractListModel::replyProcessed, this, &OrnSearchAppsModel::resultsUpdated);
 }
 
 QString OrnSearchAppsModel::searchKey() const
@@ -0,0 +1,24 @@
+#ifndef ORNSSU_H
+#define ORNSSU_H
+
+// The SSU settings shared by OrnPm and OrnSystemInfo
+
+#include <QString>
+
+// The value of the environment variable or the default value.
+// Used to run OrnPm against the fake services from scripts/fake_pm_services.py.
+#define ORN_ENV(var, value) \
+    (qEnvironmentVariableIsEmpty(var) ? QStringLiteral(value) : QString::fromLocal8Bit(qgetenv(var)))
+
+#define SSU_CONFIG_PATH        ORN_ENV("ORN_SSU_CONFIG", "/etc/ssu/ssu.ini")
+#define SSU_REPOS_GROUP        QStringLiteral("repository-urls")
+#define SSU_DISABLED_KEY       QStringLiteral("disabled-repos")
+
+#define SSU_SERVICE            ORN_ENV("ORN_SSU_SERVICE", "org.nemo.ssu")
+#define SSU_PATH               ORN_ENV("ORN_SSU_PATH", "/org/nemo/ssu")
+#define SSU_INTERFACE          QStringLiteral("org.nemo.ssu")
+#define SSU_METHOD_DISPLAYNAME "displayName"
+#define SSU_METHOD_ADDREPO     "addRepo"
+#define SSU_METHOD_MODIFYREPO  "modifyRepo"
+
+#endif // ORNSSU_H
@@ -0,0 +1,164 @@
+#include "ornsysteminfo.h"
+#include "ornssu.h"
+
+#include <QSettings>
+#include <QSysInfo>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QtDBus/QDBusInterface>
+#include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusPendingReply>
+#include <QtConcurrent/QtConcurrent>
+
+#include <QDebug>
+
+#define SYS_DEVICE_MODEL QStringLiteral("system/deviceModel")
+#define SYS_RELEASE      QStringLiteral("system/release")
+#define SYS_ARCH         QStringLiteral("system/arch")
+
+// Ssu::DeviceModel
+#define SSU_DISPLAYNAME_DEVICEMODEL 1
+
+OrnSystemInfo::OrnSystemInfo(QDBusInterface *ssuInterface, QObject *parent)
+    : QObject(parent)
+    , mSsuInterface(ssuInterface)
+    , mWatcher(new QFileSystemWatcher(this))
+{
+    // Serve the cached values until the actual ones are collected
+    QSettings settings;
+    mDeviceModel = settings.value(SYS_DEVICE_MODEL).toString();
+    mRelease = settings.value(SYS_RELEASE).toString();
+    mArch = settings.value(SYS_ARCH).toString();
+
+    QString ssuConfig(SSU_CONFIG_PATH);
+    if (QFileInfo(ssuConfig).isFile())
+    {
+        mWatcher->addPath(ssuConfig);
+    }
+    connect(mWatcher, &QFileSystemWatcher::fileChanged, this, &OrnSystemInfo::onConfigChanged);
+}
+
+QString OrnSystemInfo::deviceModel() const
+{
+    QReadLocker locker(&mLock);
+    return mDeviceModel;
+}
+
+QString OrnSystemInfo::release() const
+{
+    QReadLocker locker(&mLock);
+    return mRelease;
+}
+
+QString OrnSystemInfo::arch() const
+{
+    QReadLocker locker(&mLock);
+    return mArch;
+}
+
+QSet<QString> OrnSystemInfo::archs() const
+{
+    QReadLocker locker(&mLock);
+    return { mArch, QStringLiteral("noarch") };
+}
+
+void OrnSystemInfo::readConfig()
+{
+    QSettings ssuSettings(SSU_CONFIG_PATH, QSettings::IniFormat);
+    auto release = ssuSettings.value(QStringLiteral("release")).toString();
+    auto arch = ssuSettings.value(QStringLiteral("arch")).toString();
+    if (arch.isEmpty())
+    {
+        arch = OrnSystemInfo::defaultArch();
+        qWarning() << "Could not read arch from SSU config, using" << arch;
+    }
+
+    bool releaseChanged = false;
+    bool archChanged = false;
+    {
+        QWriteLocker locker(&mLock);
+        releaseChanged = mRelease != release;
+        archChanged = mArch != arch;
+        mRelease = release;
+        mArch = arch;
+    }
+
+    QSettings settings;
+    if (releaseChanged)
+    {
+        qDebug() << "System release is" << release;
+        settings.setValue(SYS_RELEASE, release);
+        emit this->releaseChanged();
+    }
+    if (archChanged)
+    {
+        qDebug() << "System arch is" << arch;
+        settings.setValue(SYS_ARCH, arch);
+        emit this->archChanged();
+    }
+}
+
+void OrnSystemInfo::refresh()
+{
+    QtConcurrent::run(this, &OrnSystemInfo::readConfig);
+    this->requestDeviceModel();
+}
+
+void OrnSystemInfo::onConfigChanged(const QString &path)
+{
+    // The file could be replaced so watch it again
+    if (!mWatcher->files().contains(path) && QFileInfo(path).isFile())
+    {
+        mWatcher->addPath(path);
+    }
+    qDebug() << "SSU config has changed";
+    this->refresh();
+    emit this->configChanged();
+}
+
+void OrnSystemInfo::requestDeviceModel()
+{
+    qDebug().nospace() << "Calling " << mSsuInterface << "->" SSU_METHOD_DISPLAYNAME "("
+                       << SSU_DISPLAYNAME_DEVICEMODEL << ")";
+    auto watcher = new QDBusPendingCallWatcher(mSsuInterface->asyncCall(
+            QStringLiteral(SSU_METHOD_DISPLAYNAME), SSU_DISPLAYNAME_DEVICEMODEL), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, [this, watcher]()
+    {
+        watcher->deleteLater();
+        QDBusPendingReply<QString> reply(*watcher);
+        if (reply.isError())
+        {
+            qWarning() << "Could not get device model:" << reply.error().message();
+            return;
+        }
+        auto deviceModel = reply.value();
+        if (this->deviceModel() != deviceModel)
+        {
+            {
+                QWriteLocker locker(&mLock);
+                mDeviceModel = deviceModel;
+            }
+            qDebug() << "Device model is" << deviceModel;
+            QSettings().setValue(SYS_DEVICE_MODEL, deviceModel);
+            emit this->deviceModelChanged();
+        }
+    });
+}
+
+QString OrnSystemInfo::defaultArch()
+{
+    auto arch = QSysInfo::currentCpuArchitecture();
+    if (arch == QLatin1String("arm"))
+    {
+        return QStringLiteral("armv7hl");
+    }
+    if (arch == QLatin1String("arm64"))
+    {
+        return QStringLiteral("aarch64");
+    }
+    if (arch == QLatin1String("i386"))
+    {
+        return QStringLiteral("i486");
+    }
+    return arch;
+}
@@ -0,0 +1,55 @@
+#ifndef ORNSYSTEMINFO_H
+#define ORNSYSTEMINFO_H
+
+#include <QObject>
+#include <QSet>
+#include <QReadWriteLock>
+
+class QDBusInterface;
+class QFileSystemWatcher;
+
+/**
+ * @brief The system information used by OrnPm
+ * The values are collected asynchronously and cached in memory and in the
+ * settings, so they are available right after the start. The cache is
+ * invalidated when the SSU config changes. The getters are thread safe.
+ */
+class OrnSystemInfo : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OrnSystemInfo(QDBusInterface *ssuInterface, QObject *parent = nullptr);
+
+    QString deviceModel() const;
+    QString release() const;
+    QString arch() const;
+    QSet<QString> archs() const;
+
+    void readConfig();
+
+public slots:
+    void refresh();
+    void requestDeviceModel();
+
+signals:
+    void deviceModelChanged();
+    void releaseChanged();
+    void archChanged();
+    void configChanged();
+
+private slots:
+    void onConfigChanged(const QString &path);
+
+private:
+    static QString defaultArch();
+
+    QDBusInterface *mSsuInterface;
+    QFileSystemWatcher *mWatcher;
+    mutable QReadWriteLock mLock;
+    QString mDeviceModel;
+    QString mRelease;
+    QString mArch;
+};
+
+#endif // ORNSYSTEMINFO_H
@@ -0,0 +1,325 @@
+#include "orntransactionjournal.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QMap>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
+
+#include <PackageKit/packagekit-qt5/Transaction>
+
+#include <algorithm>
+
+#include <QDebug>
+
+// The number of kept entries
+#define JOURNAL_SIZE 1000
+// The file is compacted after so many entries
+#define JOURNAL_FILE_SIZE (2 * JOURNAL_SIZE)
+
+OrnTransactionJournal::OrnTransactionJournal(const QString &path, QObject *parent)
+    : QObject(parent)
+    , mPath(path)
+    , mFileEntries(0)
+    , mTruncate(false)
+    , mWriting(false)
+{
+    this->load();
+}
+
+OrnTransactionJournal::~OrnTransactionJournal()
+{
+    // Let the last entries reach the file
+    mWriter.waitForFinished();
+}
+
+int OrnTransactionJournal::count() const
+{
+    QMutexLocker locker(&mMutex);
+    return mEntries.size();
+}
+
+void OrnTransactionJournal::begin(QObject *key, const QString &kind, const QString &item)
+{
+    Q_ASSERT(key);
+    Entry entry{QDateTime::currentMSecsSinceEpoch(), 0, 0, 0, kind, item};
+    QMutexLocker locker(&mMutex);
+    mPending.insert(key, entry);
+}
+
+QString OrnTransactionJournal::item(QObject *key) const
+{
+    QMutexLocker locker(&mMutex);
+    return mPending.value(key).item;
+}
+
+void OrnTransactionJournal::end(QObject *key, quint32 exit, quint64 bytes)
+{
+    Entry entry;
+    {
+        QMutexLocker locker(&mMutex);
+        auto it = mPending.find(key);
+        if (it == mPending.end())
+        {
+            return;
+        }
+        entry = it.value();
+        mPending.erase(it);
+    }
+    this->record(entry.kind, entry.item, entry.start, exit, bytes);
+}
+
+void OrnTransactionJournal::record(const QString &kind, const QString &item, qint64 start,
+                                   quint32 exit, quint64 bytes)
+{
+    auto duration = quint32(QDateTime::currentMSecsSinceEpoch() - start);
+    {
+        QMutexLocker locker(&mMutex);
+        this->append({start, duration, exit, bytes, kind, item});
+    }
+    emit this->changed();
+}
+
+QVariantList OrnTransactionJournal::entries(const QString &kind) const
+{
+    QMutexLocker locker(&mMutex);
+    QVariantList res;
+    for (auto it = mEntries.crbegin(); it != mEntries.crend(); ++it)
+    {
+        if (kind.isEmpty() || it->kind == kind)
+        {
+            res << QVariantMap{
+                { QStringLiteral("kind"),     it->kind },
+                { QStringLiteral("item"),     it->item },
+                { QStringLiteral("start"),    QDateTime::fromMSecsSinceEpoch(it->start) },
+                { QStringLiteral("duration"), it->duration },
+                { QStringLiteral("exit"),     it->exit },
+                { QStringLiteral("success"),  it->exit == PackageKit::Transaction::ExitSuccess },
+                { QStringLiteral("bytes"),    it->bytes }
+            };
+        }
+    }
+    return res;
+}
+
+QVariantList OrnTransactionJournal::stats() const
+{
+    // <kind, durations>
+    QMap<QString, QVector<quint32>> durations;
+    QHash<QString, int> failures;
+    {
+        QMutexLocker locker(&mMutex);
+        for (const auto &entry : mEntries)
+        {
+            durations[entry.kind] << entry.duration;
+            if (entry.exit != PackageKit::Transaction::ExitSuccess)
+            {
+                ++failures[entry.kind];
+            }
+        }
+    }
+
+    // Nearest-rank percentile of the sorted values
+    auto percentile = [](const QVector<quint32> &values, int p) -> quint32
+    {
+        auto rank = (values.size() * p + 99) / 100;
+        return values[qMax(rank, 1) - 1];
+    };
+
+    QVariantList res;
+    for (auto it = durations.begin(); it != durations.end(); ++it)
+    {
+        auto &values = it.value();
+        std::sort(values.begin(), values.end());
+        res << QVariantMap{
+            { QStringLiteral("kind"),     it.key() },
+            { QStringLiteral("count"),    values.size() },
+            { QStringLiteral("failures"), failures.value(it.key()) },
+            { QStringLiteral("p50"),      percentile(values, 50) },
+            { QStringLiteral("p95"),      percentile(values, 95) },
+            { QStringLiteral("max"),      values.last() }
+        };
+    }
+    return res;
+}
+
+bool OrnTransactionJournal::exportTo(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qWarning() << "Could not open" << filePath << "for writing";
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "start,kind,item,duration,exit,bytes\n";
+    QMutexLocker locker(&mMutex);
+    for (const auto &entry : mEntries)
+    {
+        stream << QDateTime::fromMSecsSinceEpoch(entry.start).toString(Qt::ISODate) << ','
+               << entry.kind << ',' << entry.item << ','
+               << entry.duration << ',' << entry.exit << ',' << entry.bytes << '\n';
+    }
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+void OrnTransactionJournal::clear()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        mEntries.clear();
+        mUnwritten.clear();
+        mFileEntries = 0;
+        // The file is removed by the writer so a running write does not recreate it
+        mTruncate = true;
+        this->scheduleWrite();
+    }
+    emit this->changed();
+}
+
+void OrnTransactionJournal::load()
+{
+    QFile file(mPath);
+    if (!file.open(QFile::ReadOnly))
+    {
+        return;
+    }
+
+    // Every line is "start\tduration\texit\tbytes\tkind\titem"
+    while (!file.atEnd())
+    {
+        auto fields = file.readLine().trimmed().split('\t');
+        if (fields.size() != 6)
+        {
+            continue;
+        }
+        mEntries << Entry{
+            fields[0].toLongLong(),
+            fields[1].toUInt(),
+            fields[2].toUInt(),
+            fields[3].toULongLong(),
+            QString::fromUtf8(fields[4]),
+            QString::fromUtf8(fields[5])
+        };
+        ++mFileEntries;
+    }
+
+    while (mEntries.size() > JOURNAL_SIZE)
+    {
+        mEntries.removeFirst();
+    }
+    qDebug() << "Loaded" << mEntries.size() << "journal entries from" << mPath;
+}
+
+void OrnTransactionJournal::append(const Entry &entry)
+{
+    mEntries << entry;
+    if (mEntries.size() > JOURNAL_SIZE)
+    {
+        mEntries.removeFirst();
+    }
+    mUnwritten << entry;
+    this->scheduleWrite();
+}
+
+void OrnTransactionJournal::scheduleWrite()
+{
+    // A running writer picks up the new entries
+    if (!mWriting)
+    {
+        mWriting = true;
+        mWriter = QtConcurrent::run(this, &OrnTransactionJournal::write);
+    }
+}
+
+void OrnTransactionJournal::write()
+{
+    while (true)
+    {
+        QList<Entry> entries;
+        bool truncate;
+        bool compact;
+        {
+            QMutexLocker locker(&mMutex);
+            if (mUnwritten.isEmpty() && !mTruncate)
+            {
+                mWriting = false;
+                return;
+            }
+            truncate = mTruncate;
+            mTruncate = false;
+            // Rewrite only the kept entries when the file grows too much
+            compact = mFileEntries + mUnwritten.size() > JOURNAL_FILE_SIZE;
+            if (compact)
+            {
+                entries = mEntries;
+                mFileEntries = entries.size();
+            }
+            else
+            {
+                entries = mUnwritten;
+                mFileEntries += entries.size();
+            }
+            mUnwritten.clear();
+        }
+
+        if (truncate)
+        {
+            QFile::remove(mPath);
+        }
+        if (entries.isEmpty())
+        {
+            continue;
+        }
+
+        QDir().mkpath(QFileInfo(mPath).absolutePath());
+        if (compact)
+        {
+            // The old file is kept if writing fails midway
+            QSaveFile file(mPath);
+            if (!file.open(QFile::WriteOnly))
+            {
+                qWarning() << "Could not open" << mPath << "for writing";
+                continue;
+            }
+            for (const auto &e : entries)
+            {
+                file.write(OrnTransactionJournal::serialize(e));
+            }
+            if (!file.commit())
+            {
+                qWarning() << "Could not write" << mPath << "-" << file.errorString();
+            }
+            continue;
+        }
+
+        QFile file(mPath);
+        if (!file.open(QFile::WriteOnly | QFile::Append))
+        {
+            qWarning() << "Could not open" << mPath << "for writing";
+            continue;
+        }
+        for (const auto &e : entries)
+        {
+            file.write(OrnTransactionJournal::serialize(e));
+        }
+    }
+}
+
+QByteArray OrnTransactionJournal::serialize(const Entry &entry)
+{
+    QByteArray res;
+    res.append(QByteArray::number(entry.start)).append('\t')
+       .append(QByteArray::number(entry.duration)).append('\t')
+       .append(QByteArray::number(entry.exit)).append('\t')
+       .append(QByteArray::number(entry.bytes)).append('\t')
+       .append(entry.kind.toUtf8()).append('\t')
+       .append(entry.item.toUtf8()).append('\n');
+    return res;
+}
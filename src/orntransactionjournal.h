@@ -0,0 +1,84 @@
+#ifndef ORNTRANSACTIONJOURNAL_H
+#define ORNTRANSACTIONJOURNAL_H
+
+#include <QObject>
+#include <QVariant>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QFuture>
+
+/**
+ * @brief The bounded journal of PackageKit and SSU operations
+ * Every entry holds the operation kind (a D-Bus method name), the item
+ * (a package id or a repo alias), the start time, the duration, the exit
+ * code and the bytes. The journal is appended to a file in the thread pool
+ * and survives restarts. Recording is thread safe.
+ */
+class OrnTransactionJournal : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY changed)
+
+public:
+    explicit OrnTransactionJournal(const QString &path, QObject *parent = nullptr);
+    ~OrnTransactionJournal();
+
+    int count() const;
+
+    /// Start timing the operation identified with the key
+    void begin(QObject *key, const QString &kind, const QString &item);
+    /// The item of the pending operation
+    QString item(QObject *key) const;
+    /// Finish timing the operation and record it, bytes are optional
+    void end(QObject *key, quint32 exit, quint64 bytes = 0);
+
+    /// Record the operation started at the given time and finished now
+    void record(const QString &kind, const QString &item, qint64 start,
+                quint32 exit, quint64 bytes = 0);
+
+    /// Entries of the given kind or of all kinds if it's empty, the newest first
+    Q_INVOKABLE QVariantList entries(const QString &kind = QString()) const;
+    /// Count, failures, p50, p95 and max duration for every kind
+    Q_INVOKABLE QVariantList stats() const;
+    /// Write the journal to a CSV file
+    Q_INVOKABLE bool exportTo(const QString &filePath) const;
+    Q_INVOKABLE void clear();
+
+signals:
+    void changed();
+
+private:
+    struct Entry
+    {
+        qint64 start;
+        quint32 duration;
+        quint32 exit;
+        quint64 bytes;
+        QString kind;
+        QString item;
+    };
+
+    void load();
+    // Lock the mutex before calling
+    void append(const Entry &entry);
+    // Lock the mutex before calling
+    void scheduleWrite();
+    // Write the unwritten entries, runs in the thread pool
+    void write();
+    static QByteArray serialize(const Entry &entry);
+
+    QString mPath;
+    mutable QMutex mMutex;
+    QList<Entry> mEntries;
+    // The entries which are not in the file yet
+    QList<Entry> mUnwritten;
+    int mFileEntries;
+    bool mTruncate;
+    bool mWriting;
+    QFuture<void> mWriter;
+    // <key, pending entry>
+    QHash<QObject *, Entry> mPending;
+};
+
+#endif // ORNTRANSACTIONJOURNAL_H
@@ -0,0 +1,21 @@
+#ifndef ORNUPDATABLEPACKAGE_H
+#define ORNUPDATABLEPACKAGE_H
+
+
+#include <QMetaType>
+
+struct OrnUpdatablePackage
+{
+    quint64 downloadSize;
+    quint64 installSize;
+    QString name;
+    QString id;
+    QString version;
+    QString repoAlias;
+};
+
+typedef QList<OrnUpdatablePackage> OrnUpdatablePackageList;
+
+Q_DECLARE_METATYPE(QList<OrnUpdatablePackage>)
+
+#endif // ORNUPDATABLEPACKAGE_H
@@ -0,0 +1,255 @@
+#include "ornupdatesmodel.h"
+
+#include <QDebug>
+
+OrnUpdatesModel::OrnUpdatesModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , mResetting(false)
+    , mDownloadSize(0)
+    , mInstallSize(0)
+{
+    auto ornPm = OrnPm::instance();
+    connect(ornPm, &OrnPm::updatablePackagesInfo,
+            this, &OrnUpdatesModel::onUpdatablePackagesInfo);
+    connect(ornPm, &OrnPm::packageStatusChanged,
+            this, &OrnUpdatesModel::onPackageStatusChanged);
+    connect(ornPm, &OrnPm::updatablePackagesChanged,
+            this, &OrnUpdatesModel::onUpdatablePackagesChanged);
+    connect(this, &OrnUpdatesModel::rowsInserted, this, &OrnUpdatesModel::countChanged);
+    connect(this, &OrnUpdatesModel::rowsRemoved, this, &OrnUpdatesModel::countChanged);
+    connect(this, &OrnUpdatesModel::modelReset, this, &OrnUpdatesModel::countChanged);
+    this->reset();
+}
+
+int OrnUpdatesModel::count() const
+{
+    return mData.size();
+}
+
+quint64 OrnUpdatesModel::downloadSize() const
+{
+    return mDownloadSize;
+}
+
+quint64 OrnUpdatesModel::installSize() const
+{
+    return mInstallSize;
+}
+
+QStringList OrnUpdatesModel::packageNames() const
+{
+    QStringList names;
+    for (const auto &package : mData)
+    {
+        names << package.name;
+    }
+    return names;
+}
+
+void OrnUpdatesModel::reset()
+{
+    if (mResetting)
+    {
+        return;
+    }
+    qDebug() << "Resetting model";
+    this->beginResetModel();
+    mResetting = true;
+    mData.clear();
+    OrnPm::instance()->getUpdatablePackagesInfo();
+}
+
+void OrnUpdatesModel::updateAll()
+{
+    OrnPm::instance()->updatePackages(this->packageNames());
+}
+
+void OrnUpdatesModel::onUpdatablePackagesInfo(const QString &packageName, const OrnUpdatablePackageList &packages)
+{
+    if (mResetting)
+    {
+        if (!packageName.isEmpty())
+        {
+            // Only the full list ends the reset
+            if (!mChangedPackages.contains(packageName))
+            {
+                mChangedPackages << packageName;
+            }
+            return;
+        }
+        mData.append(packages);
+        mResetting = false;
+        this->endResetModel();
+        this->updateSizes();
+
+        // The full list could have been prepared before these changes
+        auto ornPm = OrnPm::instance();
+        for (const auto &name : mChangedPackages)
+        {
+            ornPm->getUpdatablePackagesInfo(name);
+        }
+        mChangedPackages.clear();
+        return;
+    }
+
+    QModelIndex parentIndex;
+    QVector<int> roles = { IdRole, VersionRole, RepoAliasRole, DownloadSizeRole, InstallSizeRole };
+    for (const auto &package : packages)
+    {
+        auto row = this->findRow(package.name);
+        if (row == -1)
+        {
+            qDebug() << "Adding model item" << package.name;
+            row = mData.size();
+            this->beginInsertRows(parentIndex, row, row);
+            mData << package;
+            this->endInsertRows();
+        }
+        else if (mData[row].id != package.id ||
+                 mData[row].downloadSize != package.downloadSize)
+        {
+            qDebug() << "Updating model item" << package.name;
+            mData[row] = package;
+            auto ind = this->createIndex(row, 0);
+            emit this->dataChanged(ind, ind, roles);
+        }
+    }
+    this->updateSizes();
+}
+
+void OrnUpdatesModel::onPackageStatusChanged(const QString &packageName, const OrnPm::PackageStatus &status)
+{
+    switch (status)
+    {
+    case OrnPm::PackageUpdateAvailable:
+        // The update is new or has changed
+        OrnPm::instance()->getUpdatablePackagesInfo(packageName);
+        break;
+    case OrnPm::PackageInstalled:
+    case OrnPm::PackageNotInstalled:
+        // The package was updated or removed
+        this->removeItem(this->findRow(packageName));
+        break;
+    case OrnPm::PackageUpdating:
+    case OrnPm::PackageUnknownStatus:
+        {
+            auto row = this->findRow(packageName);
+            if (row != -1)
+            {
+                auto ind = this->createIndex(row, 0);
+                emit this->dataChanged(ind, ind, { UpdatingRole });
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void OrnUpdatesModel::onUpdatablePackagesChanged()
+{
+    if (mResetting)
+    {
+        return;
+    }
+
+    // Remove the packages which are not updatable anymore
+    auto updatable = OrnPm::instance()->updatablePackages().toSet();
+    for (int i = mData.size() - 1; i >= 0; --i)
+    {
+        if (!updatable.contains(mData[i].name))
+        {
+            this->removeItem(i);
+        }
+    }
+}
+
+int OrnUpdatesModel::findRow(const QString &packageName) const
+{
+    auto size = mData.size();
+    for (int i = 0; i < size; ++i)
+    {
+        if (mData[i].name == packageName)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void OrnUpdatesModel::removeItem(int row)
+{
+    if (row < 0 || mResetting)
+    {
+        return;
+    }
+    qDebug() << "Removing model item" << mData[row].name;
+    this->beginRemoveRows(QModelIndex(), row, row);
+    mData.removeAt(row);
+    this->endRemoveRows();
+    this->updateSizes();
+}
+
+void OrnUpdatesModel::updateSizes()
+{
+    quint64 downloadSize = 0;
+    quint64 installSize = 0;
+    for (const auto &package : mData)
+    {
+        downloadSize += package.downloadSize;
+        installSize  += package.installSize;
+    }
+    if (mDownloadSize != downloadSize || mInstallSize != installSize)
+    {
+        mDownloadSize = downloadSize;
+        mInstallSize  = installSize;
+        emit this->sizesChanged();
+    }
+}
+
+int OrnUpdatesModel::rowCount(const QModelIndex &parent) const
+{
+    return !parent.isValid() ? mData.size() : 0;
+}
+
+QVariant OrnUpdatesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+    {
+        return QVariant();
+    }
+
+    const auto &package = mData[index.row()];
+    switch (role)
+    {
+    case NameRole:
+        return package.name;
+    case IdRole:
+        return package.id;
+    case VersionRole:
+        return package.version;
+    case RepoAliasRole:
+        return package.repoAlias;
+    case DownloadSizeRole:
+        return package.downloadSize;
+    case InstallSizeRole:
+        return package.installSize;
+    case UpdatingRole:
+        return OrnPm::instance()->packageStatus(package.name) == OrnPm::PackageUpdating;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> OrnUpdatesModel::roleNames() const
+{
+    return {
+        { NameRole,         "packageName"         },
+        { IdRole,           "packageId"           },
+        { VersionRole,      "packageVersion"      },
+        { RepoAliasRole,    "repoAlias"           },
+        { DownloadSizeRole, "packageDownloadSize" },
+        { InstallSizeRole,  "packageInstallSize"  },
+        { UpdatingRole,     "packageUpdating"     }
+    };
+}
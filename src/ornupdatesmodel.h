@@ -0,0 +1,70 @@
+#ifndef ORNUPDATESMODEL_H
+#define ORNUPDATESMODEL_H
+
+#include <QAbstractListModel>
+
+#include "ornpm.h"
+#include "ornupdatablepackage.h"
+
+class OrnUpdatesModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(quint64 downloadSize READ downloadSize NOTIFY sizesChanged)
+    Q_PROPERTY(quint64 installSize READ installSize NOTIFY sizesChanged)
+
+public:
+
+    enum Roles
+    {
+        NameRole = Qt::UserRole + 1,
+        IdRole,
+        VersionRole,
+        RepoAliasRole,
+        DownloadSizeRole,
+        InstallSizeRole,
+        UpdatingRole
+    };
+    Q_ENUM(Roles)
+
+    explicit OrnUpdatesModel(QObject *parent = nullptr);
+
+    int count() const;
+    quint64 downloadSize() const;
+    quint64 installSize() const;
+
+    Q_INVOKABLE QStringList packageNames() const;
+
+public slots:
+    void reset();
+    void updateAll();
+
+signals:
+    void countChanged();
+    void sizesChanged();
+
+private slots:
+    void onUpdatablePackagesInfo(const QString &packageName, const OrnUpdatablePackageList &packages);
+    void onPackageStatusChanged(const QString &packageName, const OrnPm::PackageStatus &status);
+    void onUpdatablePackagesChanged();
+
+private:
+    int findRow(const QString &packageName) const;
+    void removeItem(int row);
+    void updateSizes();
+
+    bool mResetting;
+    // The packages changed while resetting, requested again after the reset
+    QStringList mChangedPackages;
+    quint64 mDownloadSize;
+    quint64 mInstallSize;
+    OrnUpdatablePackageList mData;
+
+    // QAbstractItemModel interface
+public:
+    int rowCount(const QModelIndex &parent) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+};
+
+#endif // ORNUPDATESMODEL_H
@@ -0,0 +1,25 @@
+TARGET = tst_ornjsonreader
+QT += testlib
+QT -= gui
+CONFIG += testcase c++11
+
+SRC_DIR = $$PWD/../../../src
+INCLUDEPATH += $$SRC_DIR
+
+SOURCES += \
+    tst_ornjsonreader.cpp \
+    $$SRC_DIR/ornjsonreader.cpp \
+    $$SRC_DIR/ornapplistitem.cpp \
+    $$SRC_DIR/ornappdetails.cpp \
+    $$SRC_DIR/orncategorylistitem.cpp
+
+HEADERS += \
+    $$SRC_DIR/orn.h \
+    $$SRC_DIR/ornjsonreader.h \
+    $$SRC_DIR/ornapplistitem.h \
+    $$SRC_DIR/ornappdetails.h \
+    $$SRC_DIR/orncategorylistitem.h
+
+OTHER_FILES += \
+    data/apps.json \
+    data/app.json
@@ -0,0 +1,254 @@
+#include "ornjsonreader.h"
+#include "ornapplistitem.h"
+#include "ornappdetails.h"
+#include "orncategorylistitem.h"
+#include "orn.h"
+
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+/**
+ * @brief Benchmarks of the API reply decoding
+ * Samples of an apps page and of app details are decoded with the
+ * production decoders, OrnAppListItem and OrnAppDetails, and with the
+ * QJsonDocument path they replaced. The old path fills plain values
+ * without creating the item objects, so its timings are a lower bound.
+ */
+class tst_OrnJsonReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void appsPage_data();
+    void appsPage();
+    void appDetails_data();
+    void appDetails();
+
+private:
+    static QByteArray readFile(const QString &name);
+
+    QByteArray mAppsPage;
+    QByteArray mAppDetails;
+};
+
+/// The values of OrnAppListItem read by the old path
+struct AppItem
+{
+    quint32 appId = 0;
+    quint32 created = 0;
+    quint32 updated = 0;
+    quint32 ratingCount = 0;
+    float rating = 0.0;
+    QString title;
+    QString userName;
+    QString iconSource;
+    QString category;
+};
+
+static bool sameItem(const QObject *item, const AppItem &other)
+{
+    return item->property("appId").toUInt() == other.appId &&
+            item->property("created").toUInt() == other.created &&
+            item->property("updated").toUInt() == other.updated &&
+            item->property("ratingCount").toUInt() == other.ratingCount &&
+            qFuzzyCompare(item->property("rating").toFloat() + 1, other.rating + 1) &&
+            item->property("title").toString() == other.title &&
+            item->property("userName").toString() == other.userName &&
+            item->property("iconSource").toString() == other.iconSource &&
+            item->property("category").toString() == other.category;
+}
+
+static bool sameDetails(const OrnAppDetails &a, const OrnAppDetails &b)
+{
+    return a.userId == b.userId && a.ratingCount == b.ratingCount &&
+            a.commentsCount == b.commentsCount && a.downloadsCount == b.downloadsCount &&
+            qFuzzyCompare(a.rating + 1, b.rating + 1) &&
+            a.title == b.title && a.userName == b.userName &&
+            a.userIconSource == b.userIconSource && a.iconSource == b.iconSource &&
+            a.packageName == b.packageName && a.body == b.body &&
+            a.changelog == b.changelog && a.created == b.created &&
+            a.updated == b.updated && a.categories == b.categories &&
+            a.screenshots == b.screenshots;
+}
+
+static QObjectList readAppsPage(const QByteArray &json)
+{
+    QObjectList items;
+    OrnJsonReader reader(json);
+    if (reader.beginArray())
+    {
+        while (reader.nextElement())
+        {
+            items << new OrnAppListItem(reader);
+        }
+    }
+    return items;
+}
+
+// The former OrnAppListItem(const QJsonObject &) constructor
+static QList<AppItem> readAppsPageDom(const QByteArray &json)
+{
+    QString ratingKey(QStringLiteral("rating"));
+    QString tidKey(QStringLiteral("tid"));
+
+    QList<AppItem> items;
+    auto jsonArray = QJsonDocument::fromJson(json).array();
+    for (const QJsonValue &v : jsonArray)
+    {
+        auto jsonObject = v.toObject();
+        AppItem item;
+        item.appId = jsonObject[QStringLiteral("appid")].toVariant().toUInt();
+        item.created = Orn::toUint(jsonObject[QStringLiteral("created")]);
+        item.updated = Orn::toUint(jsonObject[QStringLiteral("updated")]);
+        item.title = Orn::toString(jsonObject[QStringLiteral("title")]);
+        item.userName = Orn::toString(jsonObject[QStringLiteral("user")].toObject()[QStringLiteral("name")]);
+        item.iconSource = Orn::toString(jsonObject[QStringLiteral("icon")].toObject()[QStringLiteral("url")]);
+
+        auto ratingObject = jsonObject[ratingKey].toObject();
+        item.ratingCount = Orn::toUint(ratingObject[QStringLiteral("count")]);
+        item.rating = ratingObject[ratingKey].toString().toFloat();
+
+        auto categories = jsonObject[QStringLiteral("category")].toArray();
+        item.category = OrnCategoryListItem::categoryName(
+                    categories.isEmpty() ? 0 : Orn::toUint(categories.last().toObject()[tidKey]));
+        items << item;
+    }
+    return items;
+}
+
+// The former OrnApplication::onJsonReady(const QJsonDocument &)
+static OrnAppDetails readAppDetailsDom(const QByteArray &json)
+{
+    OrnAppDetails app;
+    auto jsonObject = QJsonDocument::fromJson(json).object();
+    QString urlKey(QStringLiteral("url"));
+    QString nameKey(QStringLiteral("name"));
+
+    app.commentsCount = Orn::toUint(jsonObject[QStringLiteral("comments_count")]);
+    app.downloadsCount = Orn::toUint(jsonObject[QStringLiteral("downloads")]);
+    app.title = Orn::toString(jsonObject[QStringLiteral("title")]);
+    app.iconSource = Orn::toString(jsonObject[QStringLiteral("icon")].toObject()[urlKey]);
+    app.packageName = Orn::toString(jsonObject[QStringLiteral("package")].toObject()[nameKey]);
+    app.body = Orn::toString(jsonObject[QStringLiteral("body")]);
+    app.changelog = Orn::toString(jsonObject[QStringLiteral("changelog")]);
+    app.created = Orn::toDateTime(jsonObject[QStringLiteral("created")]);
+    app.updated = Orn::toDateTime(jsonObject[QStringLiteral("updated")]);
+
+    auto userObject = jsonObject[QStringLiteral("user")].toObject();
+    app.userId = Orn::toUint(userObject[QStringLiteral("uid")]);
+    app.userName = Orn::toString(userObject[nameKey]);
+    app.userIconSource = Orn::toString(userObject[QStringLiteral("picture")].toObject()[urlKey]);
+
+    QString ratingKey(QStringLiteral("rating"));
+    auto ratingObject = jsonObject[ratingKey].toObject();
+    app.ratingCount = Orn::toUint(ratingObject[QStringLiteral("count")]);
+    app.rating = ratingObject[ratingKey].toString().toFloat();
+
+    // The former Orn::toIntList()
+    QString tidKey(QStringLiteral("tid"));
+    auto categories = jsonObject[QStringLiteral("category")].toArray();
+    for (const QJsonValue &v : categories)
+    {
+        auto id = Orn::toUint(v.toObject()[tidKey]);
+        app.categories << QVariantMap{
+            { "id",   id },
+            { "name", OrnCategoryListItem::categoryName(id) }
+        };
+    }
+
+    QString thumbsKey(QStringLiteral("thumbs"));
+    QString largeKey(QStringLiteral("large"));
+    auto jsonArray = jsonObject[QStringLiteral("screenshots")].toArray();
+    for (const QJsonValue &v : jsonArray)
+    {
+        auto o = v.toObject();
+        app.screenshots << QVariantMap{
+            { "url",   Orn::toString(o[urlKey]) },
+            { "thumb", Orn::toString(o[thumbsKey].toObject()[largeKey]) }
+        };
+    }
+    return app;
+}
+
+QByteArray tst_OrnJsonReader::readFile(const QString &name)
+{
+    QFile file(QFINDTESTDATA(QStringLiteral("data/") + name));
+    if (!file.open(QFile::ReadOnly))
+    {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void tst_OrnJsonReader::initTestCase()
+{
+    mAppsPage = tst_OrnJsonReader::readFile(QStringLiteral("apps.json"));
+    mAppDetails = tst_OrnJsonReader::readFile(QStringLiteral("app.json"));
+    QVERIFY(!mAppsPage.isEmpty());
+    QVERIFY(!mAppDetails.isEmpty());
+
+    // Both paths must decode the same values
+    auto items = readAppsPage(mAppsPage);
+    auto domItems = readAppsPageDom(mAppsPage);
+    QVERIFY(!items.isEmpty());
+    QCOMPARE(items.size(), domItems.size());
+    for (int i = 0; i < items.size(); ++i)
+    {
+        QVERIFY2(sameItem(items[i], domItems[i]), qPrintable(QStringLiteral("item %0").arg(i)));
+    }
+    qDeleteAll(items);
+    QVERIFY(sameDetails(OrnAppDetails::fromJson(mAppDetails), readAppDetailsDom(mAppDetails)));
+}
+
+void tst_OrnJsonReader::appsPage_data()
+{
+    QTest::addColumn<bool>("dom");
+    QTest::newRow("OrnJsonReader") << false;
+    QTest::newRow("QJsonDocument") << true;
+}
+
+void tst_OrnJsonReader::appsPage()
+{
+    QFETCH(bool, dom);
+    int count = 0;
+
+    QBENCHMARK {
+        if (dom)
+        {
+            count = readAppsPageDom(mAppsPage).size();
+        }
+        else
+        {
+            auto items = readAppsPage(mAppsPage);
+            count = items.size();
+            qDeleteAll(items);
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void tst_OrnJsonReader::appDetails_data()
+{
+    QTest::addColumn<bool>("dom");
+    QTest::newRow("OrnJsonReader") << false;
+    QTest::newRow("QJsonDocument") << true;
+}
+
+void tst_OrnJsonReader::appDetails()
+{
+    QFETCH(bool, dom);
+    OrnAppDetails app;
+
+    QBENCHMARK {
+        app = dom ? readAppDetailsDom(mAppDetails) : OrnAppDetails::fromJson(mAppDetails);
+    }
+    QVERIFY(!app.title.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_OrnJsonReader)
+
+#include "tst_ornjsonreader.moc"
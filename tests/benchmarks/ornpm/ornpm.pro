@@ -0,0 +1,26 @@
+TARGET = tst_ornpm
+QT += testlib dbus concurrent
+QT -= gui
+CONFIG += testcase c++11 link_pkgconfig
+PKGCONFIG += libsolv
+
+SRC_DIR = $$PWD/../../../src
+INCLUDEPATH += $$SRC_DIR
+
+# The corpus generator, see initTestCase()
+DEFINES += \
+    ORN_CORPUS_SCRIPT=\\\"$$PWD/../../../scripts/generate_solv_corpus.py\\\"
+
+SOURCES += \
+    tst_ornpm.cpp \
+    $$SRC_DIR/ornpm.cpp \
+    $$SRC_DIR/ornpackageversion.cpp \
+    $$SRC_DIR/ornpackageindex.cpp \
+    $$SRC_DIR/ornsysteminfo.cpp \
+    $$SRC_DIR/orntransactionjournal.cpp
+
+HEADERS += \
+    $$SRC_DIR/ornpm.h \
+    $$SRC_DIR/ornpm_p.h \
+    $$SRC_DIR/ornsysteminfo.h \
+    $$SRC_DIR/orntransactionjournal.h
@@ -0,0 +1,294 @@
+#include "ornpm_p.h"
+#include "ornpackageid.h"
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QProcess>
+
+// Set ORN_BENCH_CORPORA to a dir to keep the generated corpora between runs
+#define CORPORA_ENV "ORN_BENCH_CORPORA"
+
+/**
+ * @brief Benchmarks of the OrnPm queries
+ * Every query runs against the synthetic solv caches of 10, 100 and 1000 repos
+ * generated with scripts/generate_solv_corpus.py, which needs the python
+ * bindings of libsolv. The queries are called directly on OrnPmPrivate
+ * in the test thread instead of the thread pool.
+ */
+class tst_OrnPm : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void initialise_data();
+    void initialise();
+    void packageVersions_data();
+    void packageVersions();
+    void installedPackages_data();
+    void installedPackages();
+    void updatablePackagesInfo_data();
+    void updatablePackagesInfo();
+    void installPreview_data();
+    void installPreview();
+    void findPackages_data();
+    void findPackages();
+    void availablePackages_data();
+    void availablePackages();
+
+private:
+    void addCorpora();
+    OrnPmPrivate *select(const QString &root);
+    // The newest versions of the ORN packages which are installed or not
+    static QStringList packageIds(OrnPmPrivate *d, bool installed);
+
+    QTemporaryDir mTempDir;
+    QString mCorporaDir;
+    QHash<QString, OrnPm *> mPms;
+};
+
+static const int gRepoCounts[] = { 10, 100, 1000 };
+
+void tst_OrnPm::initTestCase()
+{
+    // Keep the journal and the settings away from the user ones
+    QStandardPaths::setTestModeEnabled(true);
+
+    mCorporaDir = qEnvironmentVariableIsEmpty(CORPORA_ENV) ?
+                mTempDir.path() : QString::fromLocal8Bit(qgetenv(CORPORA_ENV));
+    for (auto repos : gRepoCounts)
+    {
+        auto root = QStringLiteral("%0/repos-%1").arg(mCorporaDir).arg(repos);
+        if (QFileInfo(root + QStringLiteral("/ssu.ini")).isFile())
+        {
+            continue;
+        }
+        auto res = QProcess::execute(QStringLiteral("python3"), {
+            QStringLiteral(ORN_CORPUS_SCRIPT), root,
+            QStringLiteral("--repos"), QString::number(repos)
+        });
+        if (res != 0)
+        {
+            QSKIP("Could not generate the solv corpus, are the libsolv python bindings installed?");
+        }
+    }
+}
+
+void tst_OrnPm::cleanupTestCase()
+{
+    // The destructor is private, so not qDeleteAll()
+    for (auto ornPm : mPms)
+    {
+        delete ornPm;
+    }
+    mPms.clear();
+}
+
+void tst_OrnPm::addCorpora()
+{
+    QTest::addColumn<QString>("root");
+    for (auto repos : gRepoCounts)
+    {
+        QTest::newRow(qPrintable(QStringLiteral("%0 repos").arg(repos)))
+                << QStringLiteral("%0/repos-%1").arg(mCorporaDir).arg(repos);
+    }
+}
+
+OrnPmPrivate *tst_OrnPm::select(const QString &root)
+{
+    // The solv paths are read from the environment on every use
+    qputenv("ORN_SOLV_ROOT", QFile::encodeName(root));
+    qputenv("ORN_SSU_CONFIG", QFile::encodeName(root + QStringLiteral("/ssu.ini")));
+
+    auto ornPm = mPms.value(root);
+    if (!ornPm)
+    {
+        ornPm = new OrnPm();
+        ornPm->d_ptr->initialise();
+        mPms.insert(root, ornPm);
+    }
+    return ornPm->d_ptr;
+}
+
+QStringList tst_OrnPm::packageIds(OrnPmPrivate *d, bool installed)
+{
+    QStringList ids;
+    d->packageIndex.update(d->sysInfo->archs());
+    auto packages = d->packageIndex.findPrefix(QStringLiteral("harbour-"));
+    for (auto it = packages.cbegin(); it != packages.cend(); ++it)
+    {
+        if (d->installedPackages.contains(it.key()) == installed && !it.value().isEmpty())
+        {
+            ids << it.value().first().packageId(it.key());
+        }
+    }
+    return ids;
+}
+
+void tst_OrnPm::initialise_data()
+{
+    this->addCorpora();
+}
+
+void tst_OrnPm::initialise()
+{
+    QFETCH(QString, root);
+    auto d = this->select(root);
+
+    QBENCHMARK {
+        d->installedPackages.clear();
+        d->initialise();
+    }
+    QVERIFY(d->initialised);
+    QVERIFY(!d->repos.isEmpty());
+}
+
+void tst_OrnPm::packageVersions_data()
+{
+    this->addCorpora();
+}
+
+void tst_OrnPm::packageVersions()
+{
+    QFETCH(QString, root);
+    auto d = this->select(root);
+    auto ids = tst_OrnPm::packageIds(d, true);
+    QVERIFY(!ids.isEmpty());
+    auto name = OrnPackageId(ids.first()).name().toString();
+
+    QBENCHMARK {
+        d->preparePackageVersions(name);
+    }
+}
+
+void tst_OrnPm::installedPackages_data()
+{
+    this->addCorpora();
+}
+
+void tst_OrnPm::installedPackages()
+{
+    QFETCH(QString, root);
+    auto d = this->select(root);
+
+    QBENCHMARK {
+        d->prepareInstalledPackages(QString());
+    }
+}
+
+void tst_OrnPm::updatablePackagesInfo_data()
+{
+    this->addCorpora();
+}
+
+void tst_OrnPm::updatablePackagesInfo()
+{
+    QFETCH(QString, root);
+    auto d = this->select(root);
+
+    // Pretend the newest versions of the installed packages are the updates
+    d->updatablePackages.clear();
+    for (const auto &packageId : tst_OrnPm::packageIds(d, true))
+    {
+        OrnPackageId id(packageId);
+        auto name = id.name().toString();
+        if (d->installedPackages.value(name) != id.version())
+        {
+            d->updatablePackages.insert(name, packageId);
+        }
+    }
+    QVERIFY(!d->updatablePackages.isEmpty());
+
+    QBENCHMARK {
+        d->prepareUpdatablePackagesInfo(QString());
+    }
+}
+
+void tst_OrnPm::installPreview_data()
+{
+    QTest::addColumn<QString>("root");
+    QTest::addColumn<bool>("cold");
+    for (auto repos : gRepoCounts)
+    {
+        auto root = QStringLiteral("%0/repos-%1").arg(mCorporaDir).arg(repos);
+        QTest::newRow(qPrintable(QStringLiteral("%0 repos").arg(repos)))
+                << root << false;
+        QTest::newRow(qPrintable(QStringLiteral("%0 repos, pool reload").arg(repos)))
+                << root << true;
+    }
+}
+
+void tst_OrnPm::installPreview()
+{
+    QFETCH(QString, root);
+    QFETCH(bool, cold);
+    auto d = this->select(root);
+    auto ids = tst_OrnPm::packageIds(d, false);
+    QVERIFY(!ids.isEmpty());
+    auto packageId = ids.first();
+
+    // Load the pool of this corpus
+    d->invalidatePool();
+    d->prepareInstallPreview(packageId);
+
+    QBENCHMARK {
+        if (cold)
+        {
+            d->invalidatePool();
+        }
+        d->prepareInstallPreview(packageId);
+    }
+}
+
+void tst_OrnPm::findPackages_data()
+{
+    QTest::addColumn<QString>("root");
+    QTest::addColumn<bool>("prefix");
+    for (auto repos : gRepoCounts)
+    {
+        auto root = QStringLiteral("%0/repos-%1").arg(mCorporaDir).arg(repos);
+        QTest::newRow(qPrintable(QStringLiteral("%0 repos, name").arg(repos)))
+                << root << false;
+        QTest::newRow(qPrintable(QStringLiteral("%0 repos, prefix").arg(repos)))
+                << root << true;
+    }
+}
+
+void tst_OrnPm::findPackages()
+{
+    QFETCH(QString, root);
+    QFETCH(bool, prefix);
+    auto d = this->select(root);
+    auto ids = tst_OrnPm::packageIds(d, false);
+    QVERIFY(!ids.isEmpty());
+    auto query = OrnPackageId(ids.first()).name().toString();
+    if (prefix)
+    {
+        query.truncate(QStringLiteral("harbour-").size() + 1);
+    }
+
+    QBENCHMARK {
+        d->findPackages(query, prefix);
+    }
+}
+
+void tst_OrnPm::availablePackages_data()
+{
+    this->addCorpora();
+}
+
+void tst_OrnPm::availablePackages()
+{
+    QFETCH(QString, root);
+    auto d = this->select(root);
+
+    QBENCHMARK {
+        d->prepareAvailablePackages();
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_OrnPm)
+
+#include "tst_ornpm.moc"
@@ -0,0 +1,5 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    benchmarks/ornjsonreader \
+    benchmarks/ornpm